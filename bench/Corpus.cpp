@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+
+#include "Corpus.hpp"
+
+namespace {
+
+// splitmix64: tiny, fast and identical everywhere
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : _state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform enough in [0, bound) for benchmark data
+    std::uint32_t below(std::uint64_t bound) {
+        return static_cast<std::uint32_t>(next() % bound);
+    }
+
+private:
+    std::uint64_t _state;
+};
+
+constexpr std::array<const char*, 10> kArithmetic = {"add", "sub", "and", "or", "xor",
+                                                     "sll", "srl", "sra", "slt", "sltu"};
+constexpr std::array<const char*, 6> kImmediate = {"addi", "andi", "ori", "xori", "slti", "sltiu"};
+constexpr std::array<const char*, 3> kShift = {"slli", "srli", "srai"};
+constexpr std::array<const char*, 5> kLoad = {"lb", "lh", "lw", "lbu", "lhu"};
+constexpr std::array<const char*, 3> kStore = {"sb", "sh", "sw"};
+constexpr std::array<const char*, 6> kBranch = {"beq", "bne", "blt", "bge", "bltu", "bgeu"};
+constexpr std::array<const char*, 2> kUpper = {"lui", "auipc"};
+
+constexpr std::array<const char*, 32> kAbiNames = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2", "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"};
+
+// Branches reach +-4 KiB; stay well inside it
+constexpr std::int64_t kReach = 1000;
+
+class Generator {
+public:
+    Generator(const CorpusOptions& options, std::string& out)
+        : _options(options), _random(options.seed), _out(out)
+    {
+        _labelEvery = std::max(1u, options.labelEvery);
+        _labelCount = (options.instructions + _labelEvery - 1) / _labelEvery;
+    }
+
+    void run() {
+        const InstructionMix& m = _options.mix;
+        const std::array<unsigned, 8> weights = {m.arithmetic, m.immediate, m.shift, m.load,
+                                                 m.store, m.branch, m.jump, m.upper};
+        unsigned total = 0;
+        for (unsigned w : weights) {
+            total += w;
+        }
+
+        for (std::size_t i = 0; i < _options.instructions; ++i) {
+            if (i % _labelEvery == 0) {
+                _out += 'L';
+                _out += std::to_string(i / _labelEvery);
+                _out += ": ";
+            }
+            unsigned pick = total ? _random.below(total) : 0;
+            std::size_t kind = 0;
+            while (kind + 1 < weights.size() && pick >= weights[kind]) {
+                pick -= weights[kind++];
+            }
+            instruction(kind, i);
+            _out += '\n';
+        }
+    }
+
+private:
+    template <std::size_t N>
+    void mnemonic(const std::array<const char*, N>& names) {
+        _out += names[_random.below(N)];
+        _out += ' ';
+    }
+
+    void reg() {
+        unsigned r = _random.below(32);
+        if (_options.abiNames) {
+            _out += kAbiNames[r];
+        } else {
+            _out += 'x';
+            _out += std::to_string(r);
+        }
+    }
+
+    // Non-negative immediate in [0, limit), decimal or hex
+    void imm(std::uint32_t limit) {
+        std::uint32_t value = _random.below(limit);
+        char buffer[16];
+        if (_random.below(2)) {
+            buffer[0] = '0';
+            buffer[1] = 'x';
+            auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), value, 16);
+            _out.append(buffer, result.ptr);
+        } else {
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            _out.append(buffer, result.ptr);
+        }
+    }
+
+    // Signed immediate: one in four in [-negative, -1], written in decimal
+    // (the lexer takes '-' only on decimals), otherwise imm(limit)
+    void simm(std::uint32_t negative, std::uint32_t limit) {
+        if (_random.below(4) == 0) {
+            _out += '-';
+            _out += std::to_string(1 + _random.below(negative));
+        } else {
+            imm(limit);
+        }
+    }
+
+    // A label whose address is within reach of instruction 'index'
+    void target(std::size_t index) {
+        auto at = static_cast<std::int64_t>(index);
+        auto every = static_cast<std::int64_t>(_labelEvery);
+        auto first = std::max<std::int64_t>(0, (at - kReach + every - 1) / every);
+        auto last = std::min<std::int64_t>(static_cast<std::int64_t>(_labelCount) - 1, (at + kReach) / every);
+        if (first > last) {
+            _out += "8";    // Labels too sparse to reach: a plain offset
+            return;
+        }
+        _out += 'L';
+        _out += std::to_string(first + _random.below(last - first + 1));
+    }
+
+    void sep() { _out += ", "; }
+
+    void instruction(std::size_t kind, std::size_t index) {
+        switch (kind) {
+            case 0:     // rd, rs1, rs2
+                mnemonic(kArithmetic); reg(); sep(); reg(); sep(); reg();
+                break;
+            case 1:     // rd, rs1, imm12
+                mnemonic(kImmediate); reg(); sep(); reg(); sep(); simm(2048, 4096);
+                break;
+            case 2:     // rd, rs1, shamt
+                mnemonic(kShift); reg(); sep(); reg(); sep(); imm(32);
+                break;
+            case 3:     // rd, offset(rs1)
+            case 4:     // rs2, offset(rs1)
+                if (kind == 3) {
+                    mnemonic(kLoad);
+                } else {
+                    mnemonic(kStore);
+                }
+                reg(); sep(); simm(2048, 2048); _out += '('; reg(); _out += ')';
+                break;
+            case 5:     // rs1, rs2, label
+                mnemonic(kBranch); reg(); sep(); reg(); sep(); target(index);
+                break;
+            case 6:
+                if (_random.below(2)) {
+                    _out += "jal "; reg(); sep(); target(index);
+                } else {
+                    _out += "jalr "; reg(); sep(); simm(2048, 2048); _out += '('; reg(); _out += ')';
+                }
+                break;
+            default:    // rd, imm20
+                mnemonic(kUpper); reg(); sep(); imm(1u << 20);
+                break;
+        }
+    }
+
+    const CorpusOptions& _options;
+    Random _random;
+    std::string& _out;
+    std::size_t _labelEvery;
+    std::size_t _labelCount;
+};
+
+} // namespace
+
+std::string generateProgram(const CorpusOptions& options) {
+    std::string out;
+    out.reserve(options.instructions * 24);
+    Generator(options, out).run();
+    return out;
+}
+
+bool parseMix(std::string_view spec, InstructionMix& mix) {
+    while (!spec.empty()) {
+        std::size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = (comma == std::string_view::npos) ? std::string_view() : spec.substr(comma + 1);
+
+        std::size_t equals = item.find('=');
+        if (equals == std::string_view::npos) {
+            return false;
+        }
+        std::string_view name = item.substr(0, equals);
+        std::string_view number = item.substr(equals + 1);
+        unsigned weight = 0;
+        auto result = std::from_chars(number.data(), number.data() + number.size(), weight);
+        if (result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+            return false;
+        }
+
+        if (name == "arithmetic")     mix.arithmetic = weight;
+        else if (name == "immediate") mix.immediate = weight;
+        else if (name == "shift")     mix.shift = weight;
+        else if (name == "load")      mix.load = weight;
+        else if (name == "store")     mix.store = weight;
+        else if (name == "branch")    mix.branch = weight;
+        else if (name == "jump")      mix.jump = weight;
+        else if (name == "upper")     mix.upper = weight;
+        else return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Relative weights of the instruction classes in a generated program
+struct InstructionMix {
+    unsigned arithmetic = 30;   // add, sub, and, or, xor, sll, ...
+    unsigned immediate  = 25;   // addi, andi, ori, xori, slti, sltiu
+    unsigned shift      = 5;    // slli, srli, srai
+    unsigned load       = 15;   // lb, lh, lw, lbu, lhu
+    unsigned store      = 10;   // sb, sh, sw
+    unsigned branch     = 10;   // beq, bne, blt, bge, bltu, bgeu (to labels)
+    unsigned jump       = 3;    // jal (to labels), jalr
+    unsigned upper      = 2;    // lui, auipc
+};
+
+struct CorpusOptions {
+    std::size_t instructions = 10000;
+    std::uint64_t seed = 1;
+    InstructionMix mix;
+    unsigned labelEvery = 32;   // A label every this many instructions
+    bool abiNames = false;      // a0, sp, ... instead of x10, x2, ...
+};
+
+// Generate an RV32I program that the lexer and assembler accept. The same
+// options (seed included) always give byte-identical output: the generator
+// uses its own PRNG and no <random> distributions, whose results differ
+// between standard libraries.
+//
+// Immediates are written in decimal or hex; I- and S-type ones (addi,
+// loads, stores, jalr, ...) are negative decimals about a quarter of the
+// time. Branch and jal targets are labels chosen within the instruction's
+// reach.
+std::string generateProgram(const CorpusOptions& options);
+
+// Parse "arithmetic=30,load=15,..." into 'mix'; classes not named keep
+// their value. False on an unknown class or a malformed weight.
+bool parseMix(std::string_view spec, InstructionMix& mix);
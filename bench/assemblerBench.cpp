@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/Assembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/Reader.hpp"
+#include "../include/ThreadPool.hpp"
+#include "Corpus.hpp"
+
+namespace {
+
+const Encoder& encoder() {
+    static const Encoder instance = [] {
+        std::unordered_map<std::string, std::vector<Token>> paramMap;
+        std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+        parseInstructionFile(NANOFORGE_SPEC_PATH, paramMap, binaryMap);
+        return Encoder(paramMap, binaryMap);
+    }();
+    return instance;
+}
+
+} // namespace
+
+// Lex, assemble and encode a generated program end to end
+static void BM_AssembleProgram(benchmark::State& state) {
+    CorpusOptions options;
+    options.instructions = static_cast<std::size_t>(state.range(0));
+    std::string source = generateProgram(options);
+
+    Assembler assembler(encoder());
+    std::vector<std::uint32_t> words;
+    for (auto _ : state) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens);
+        assembler.reset();
+        if (!assembler.assemble(lexer)) {
+            state.SkipWithError("generated program did not assemble");
+            break;
+        }
+        assembler.encode(words);
+        benchmark::DoNotOptimize(words.data());
+    }
+    state.counters["instructions/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * options.instructions), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+BENCHMARK(BM_AssembleProgram)->Arg(1000)->Arg(100000)->UseRealTime();
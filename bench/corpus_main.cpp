@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Corpus.hpp"
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <output.s>\n"
+              << "  -n <count>         Instructions to generate (default 10000)\n"
+              << "  --seed <seed>      PRNG seed (default 1)\n"
+              << "  --mix <weights>    e.g. arithmetic=30,immediate=25,shift=5,load=15,\n"
+              << "                     store=10,branch=10,jump=3,upper=2\n"
+              << "  --label-every <n>  One label per n instructions (default 32)\n"
+              << "  --abi              Use ABI register names\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CorpusOptions options;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-n" && hasValue) {
+            options.instructions = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--mix" && hasValue) {
+            if (!parseMix(argv[++i], options.mix)) {
+                std::cerr << "Invalid instruction mix: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--label-every" && hasValue) {
+            options.labelEvery = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--abi") {
+            options.abiNames = true;
+        } else if (arg[0] != '-' && outputPath.empty()) {
+            outputPath = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (outputPath.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string program = generateProgram(options);
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    out.write(program.data(), static_cast<std::streamsize>(program.size()));
+    if (!out) {
+        std::cerr << "Failed to write " << outputPath << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/ASTFactory.hpp"
+#include "../include/FlatTree.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/Reader.hpp"
+#include "../include/SyntaxChecker.hpp"
+#include "../include/ThreadPool.hpp"
+#include "Corpus.hpp"
+
+namespace {
+
+using ParamMap = std::unordered_map<std::string, std::vector<Token>>;
+using BinaryMap = std::unordered_map<std::string, std::vector<BitField>>;
+
+const char* leafName(const Token& param) {
+    switch (param.type) {
+        case TokenType::REGISTER:  return "register";
+        case TokenType::IMMEDIATE: return "immediate";
+        default:                   return "punctuation";
+    }
+}
+
+// A program tree: 'program' over one node per instruction of a generated
+// corpus, each with one leaf per operand. Checker maps gain entries for
+// 'program' and the leaves, so the tree is valid.
+struct ProgramShape {
+    ParamMap paramMap;
+    std::vector<std::string> instructions;
+};
+
+ProgramShape programShape(std::size_t instructions) {
+    ProgramShape shape;
+    BinaryMap binaryMap;
+    if (!parseInstructionFile(NANOFORGE_SPEC_PATH, shape.paramMap, binaryMap)) {
+        std::abort();
+    }
+
+    CorpusOptions options;
+    options.instructions = instructions;
+    std::string source = generateProgram(options);
+    std::deque<Token> tokens;
+    Lexer lexer(source, tokens);
+    for (const Token& token : tokens) {
+        if (token.type == TokenType::INSTRUCTION) {
+            shape.instructions.emplace_back(lexer.lexeme(token));
+        }
+    }
+
+    shape.paramMap["program"] = std::vector<Token>(shape.instructions.size(), Token(TokenType::INSTRUCTION));
+    shape.paramMap["register"];
+    shape.paramMap["immediate"];
+    shape.paramMap["punctuation"];
+    return shape;
+}
+
+template <typename MakeNode>
+void buildProgram(AbstractTree<std::string>& tree, const ProgramShape& shape, MakeNode makeNode) {
+    auto* root = makeNode("program");
+    for (const std::string& name : shape.instructions) {
+        auto* node = makeNode(name);
+        for (const Token& param : shape.paramMap.at(name)) {
+            node->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(makeNode(leafName(param))));
+        }
+        root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(node));
+    }
+    tree.setRoot(root);
+}
+
+std::size_t nodeCount(const ProgramShape& shape) {
+    std::size_t nodes = 1;
+    for (const std::string& name : shape.instructions) {
+        nodes += 1 + shape.paramMap.at(name).size();
+    }
+    return nodes;
+}
+
+} // namespace
+
+static void BM_ParseInstructionFile(benchmark::State& state) {
+    for (auto _ : state) {
+        ParamMap paramMap;
+        BinaryMap binaryMap;
+        bool ok = parseInstructionFile(NANOFORGE_SPEC_PATH, paramMap, binaryMap);
+        benchmark::DoNotOptimize(ok);
+        state.counters["instructions"] = static_cast<double>(paramMap.size());
+    }
+}
+BENCHMARK(BM_ParseInstructionFile);
+
+static void BM_CheckSyntaxTree(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    buildProgram(*tree, shape, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+    SyntaxChecker checker(shape.paramMap);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checker.checkSyntax(*tree));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * shape.instructions.size()));
+}
+BENCHMARK(BM_CheckSyntaxTree)->Arg(1000)->Arg(100000);
+
+// The tree check with top-level subtrees spread over a pool
+static void BM_CheckSyntaxTreeParallel(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    buildProgram(*tree, shape, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+    SyntaxChecker checker(shape.paramMap);
+    ThreadPool pool(static_cast<unsigned>(state.range(1)));
+
+    for (auto _ : state) {
+        Diagnostics diagnostics;
+        benchmark::DoNotOptimize(checker.checkSyntax(*tree, diagnostics, pool));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * shape.instructions.size()));
+}
+BENCHMARK(BM_CheckSyntaxTreeParallel)->Args({1000000, 1})->Args({1000000, 4})->Args({1000000, 8})->UseRealTime();
+
+static void BM_CheckSyntaxFlatTree(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    buildProgram(*tree, shape, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+    FlatTree<std::string> flat = flatten(*tree);
+    SyntaxChecker checker(shape.paramMap);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checker.checkSyntax(flat));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * shape.instructions.size()));
+}
+BENCHMARK(BM_CheckSyntaxFlatTree)->Arg(1000)->Arg(100000);
+
+// Lex + build the tree + check, the tree path end to end
+static void BM_CheckSyntaxLexBuildTree(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    CorpusOptions options;
+    options.instructions = static_cast<std::size_t>(state.range(0));
+    std::string source = generateProgram(options);
+    SyntaxChecker checker(shape.paramMap);
+
+    for (auto _ : state) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens);
+        benchmark::DoNotOptimize(tokens.size());
+        std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+        buildProgram(*tree, shape, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+        benchmark::DoNotOptimize(checker.checkSyntax(*tree));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * shape.instructions.size()));
+}
+BENCHMARK(BM_CheckSyntaxLexBuildTree)->Arg(1000)->Arg(100000);
+
+// Lex + check straight from the token stream, no tree
+static void BM_CheckSyntaxStream(benchmark::State& state) {
+    ParamMap paramMap;
+    BinaryMap binaryMap;
+    if (!parseInstructionFile(NANOFORGE_SPEC_PATH, paramMap, binaryMap)) {
+        std::abort();
+    }
+    CorpusOptions options;
+    options.instructions = static_cast<std::size_t>(state.range(0));
+    std::string source = generateProgram(options);
+    SyntaxChecker checker(paramMap);
+
+    for (auto _ : state) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens, LexMode::Streaming);
+        benchmark::DoNotOptimize(checker.checkSyntax(lexer));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * options.instructions));
+}
+BENCHMARK(BM_CheckSyntaxStream)->Arg(1000)->Arg(100000);
+
+// Build and clear through ASTFactory, heap nodes
+static void BM_TreeBuildClearHeap(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    for (auto _ : state) {
+        buildProgram(*tree, shape, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+        tree->clear();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount(shape)));
+}
+BENCHMARK(BM_TreeBuildClearHeap)->Arg(1000)->Arg(100000);
+
+// Same through the arena factory
+static void BM_TreeBuildClearArena(benchmark::State& state) {
+    ProgramShape shape = programShape(static_cast<std::size_t>(state.range(0)));
+    Arena arena;
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree(arena));
+    for (auto _ : state) {
+        buildProgram(*tree, shape, [&](const std::string& v) { return ASTFactory<std::string>::createNode(arena, v); });
+        tree->clear();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * nodeCount(shape)));
+}
+BENCHMARK(BM_TreeBuildClearArena)->Arg(1000)->Arg(100000);
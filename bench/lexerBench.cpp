@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <map>
+#include <string>
+
+#include "../include/Lexer.hpp"
+#include "Corpus.hpp"
+
+namespace {
+
+// Generated once per size and reused by every benchmark
+const std::string& corpus(std::size_t instructions) {
+    static std::map<std::size_t, std::string> cache;
+    auto it = cache.find(instructions);
+    if (it == cache.end()) {
+        CorpusOptions options;
+        options.instructions = instructions;
+        it = cache.emplace(instructions, generateProgram(options)).first;
+    }
+    return it->second;
+}
+
+// Lines of 16 words, every word of the same token class
+std::string singleClassSource(TokenType type, std::size_t lines) {
+    static const char* const registers[] = {"x1", "x17", "a0", "sp", "zero", "t6", "s11", "x31"};
+    static const char* const immediates[] = {"7", "2047", "0x1f", "0xABC", "0b1010", "42", "0x7ff", "1"};
+    static const char* const instructions[] = {"add", "addi", "lw", "sw", "beq", "jal", "sltiu", "lui"};
+    static const char* const labels[] = {"loop:", "end:", "L1:", "start:", "L42:", "body:", "L7:", "exit:"};
+    static const char* const punctuation[] = {"(", ")", "(", ")", "(", ")", "(", ")"};
+    static const char* const words[] = {"foo", "_bar", "baz9", "L1", "loop", "end", "qux", "tmp"};
+
+    const char* const* pool = words;
+    switch (type) {
+        case TokenType::REGISTER:    pool = registers; break;
+        case TokenType::IMMEDIATE:   pool = immediates; break;
+        case TokenType::INSTRUCTION: pool = instructions; break;
+        case TokenType::LABEL:       pool = labels; break;
+        case TokenType::PUNCTUATION: pool = punctuation; break;
+        default:                     break;
+    }
+
+    std::string source;
+    for (std::size_t line = 0; line < lines; ++line) {
+        for (std::size_t w = 0; w < 16; ++w) {
+            source += pool[(line + w) % 8];
+            source += ' ';
+        }
+        source += '\n';
+    }
+    return source;
+}
+
+void lexAll(benchmark::State& state, std::string_view source, LexMode mode) {
+    std::size_t tokens = 0;
+    for (auto _ : state) {
+        std::deque<Token> out;
+        Lexer lexer(source, out, mode);
+        if (mode == LexMode::Streaming) {
+            while (lexer.hasMoreTokens()) {
+                benchmark::DoNotOptimize(lexer.getNextToken());
+                ++tokens;
+            }
+        } else {
+            tokens += out.size();
+            benchmark::DoNotOptimize(out.back());
+        }
+    }
+    state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+} // namespace
+
+// Whole-program lexing, per mode
+static void BM_LexerEager(benchmark::State& state) {
+    lexAll(state, corpus(static_cast<std::size_t>(state.range(0))), LexMode::Eager);
+}
+BENCHMARK(BM_LexerEager)->Arg(1000)->Arg(100000);
+
+static void BM_LexerStreaming(benchmark::State& state) {
+    lexAll(state, corpus(static_cast<std::size_t>(state.range(0))), LexMode::Streaming);
+}
+BENCHMARK(BM_LexerStreaming)->Arg(1000)->Arg(100000);
+
+static void BM_LexerParallel(benchmark::State& state) {
+    lexAll(state, corpus(static_cast<std::size_t>(state.range(0))), LexMode::Parallel);
+}
+BENCHMARK(BM_LexerParallel)->Arg(100000)->Arg(1000000)->UseRealTime();
+
+// Tokenizing one token class at a time (through the eager constructor, as
+// tokenize() itself is private)
+static void BM_TokenizeClass(benchmark::State& state) {
+    auto type = static_cast<TokenType>(state.range(0));
+    static std::map<TokenType, std::string> sources;
+    auto it = sources.find(type);
+    if (it == sources.end()) {
+        it = sources.emplace(type, singleClassSource(type, 4096)).first;
+    }
+    lexAll(state, it->second, LexMode::Eager);
+}
+BENCHMARK(BM_TokenizeClass)
+    ->ArgName("class")
+    ->Arg(static_cast<int>(TokenType::INSTRUCTION))
+    ->Arg(static_cast<int>(TokenType::REGISTER))
+    ->Arg(static_cast<int>(TokenType::IMMEDIATE))
+    ->Arg(static_cast<int>(TokenType::LABEL))
+    ->Arg(static_cast<int>(TokenType::PUNCTUATION))
+    ->Arg(static_cast<int>(TokenType::ERROR));
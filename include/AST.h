@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <memory> // Needed for std::unique_ptr
+#include <span>
 
 // Abstract class for a generic tree node
 template <typename T>
@@ -10,8 +11,9 @@ class AbstractTreeNode {
 public:
     virtual ~AbstractTreeNode() = default;
 
-    // Get the value stored in the node
-    virtual T getValue() const = 0;
+    // Get the value stored in the node (by reference, so walks over the tree
+    // do not copy it)
+    virtual const T& getValue() const = 0;
 
     // Set the value of the node
     virtual void setValue(const T& value) = 0;
@@ -19,11 +21,15 @@ public:
     // Add a child node using a unique_ptr
     virtual void addChild(std::unique_ptr<AbstractTreeNode<T>> child) = 0;
 
-    // Get all child nodes (stored as unique_ptr)
-    virtual const std::vector<std::unique_ptr<AbstractTreeNode<T>>>& getChildren() const = 0;
+    // Get all child nodes (stored as unique_ptr). A span, so that node types
+    // are free to keep their children in any contiguous container.
+    virtual std::span<const std::unique_ptr<AbstractTreeNode<T>>> getChildren() const = 0;
 
     // Remove a child node by raw pointer reference
     virtual bool removeChild(AbstractTreeNode<T>* child) = 0;
+
+    // Move all children out of this node and append them to 'out'
+    virtual void releaseChildren(std::vector<std::unique_ptr<AbstractTreeNode<T>>>& out) = 0;
 };
 
 // Abstract class for a generic tree
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "AST.h"         // Abstract interfaces
+#include "Arena.hpp"     // Bump allocator for arena mode
+#include "ArenaTreeNode.hpp" // Arena-backed TreeNode
 #include "TreeNode.hpp"  // Concrete TreeNode
 #include "SyntaxTree.hpp"// Concrete SyntaxTree
 
@@ -16,4 +18,16 @@ public:
         // Return a new SyntaxTree
         return new SyntaxTree<T>();
     }
+
+    // Arena mode: nodes and their child arrays are bump-allocated from
+    // 'arena', and the tree's clear() returns the memory with one arena
+    // reset (see SyntaxTree::clear() for when it still visits the nodes).
+    // Arena trees only accept arena nodes.
+    static AbstractTreeNode<T>* createNode(Arena& arena, const T& value) {
+        return new (arena) ArenaTreeNode<T>(arena, value);
+    }
+
+    static AbstractTree<T>* createTree(Arena& arena) {
+        return new SyntaxTree<T>(arena);
+    }
 };
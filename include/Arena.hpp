@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Bump allocator: memory comes out of large blocks and is only given back
+// all at once. reset() rewinds to the first block but keeps every block, so
+// repeated build/clear cycles stop calling malloc altogether.
+//
+// As a std::pmr::memory_resource it can also back pmr containers; their
+// deallocations are no-ops.
+class Arena final : public std::pmr::memory_resource {
+public:
+    explicit Arena(std::size_t blockSize = 64 * 1024)
+        : _blockSize(blockSize), _current(0), _ptr(nullptr), _end(nullptr) {}
+
+    ~Arena() override {
+        release();
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Forget every allocation, keep the blocks for reuse (O(1))
+    void reset() {
+        _current = 0;
+        _ptr = _blocks.empty() ? nullptr : _blocks[0].data;
+        _end = _blocks.empty() ? nullptr : _blocks[0].data + _blocks[0].size;
+    }
+
+    // Forget every allocation and free the blocks
+    void release() {
+        for (auto& block : _blocks) {
+            ::operator delete(block.data);
+        }
+        _blocks.clear();
+        _current = 0;
+        _ptr = nullptr;
+        _end = nullptr;
+    }
+
+    std::size_t blockCount() const { return _blocks.size(); }
+
+private:
+    struct Block {
+        char* data;
+        std::size_t size;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        char* p = alignUp(_ptr, alignment);
+        if (!_ptr || p + bytes > _end) {
+            nextBlock(bytes + alignment);
+            p = alignUp(_ptr, alignment);
+        }
+        _ptr = p + bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+        // Memory is only reclaimed by reset()/release()
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    static char* alignUp(char* p, std::size_t alignment) {
+        auto value = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>((value + alignment - 1) & ~(alignment - 1));
+    }
+
+    // Move to the next block that can hold 'minBytes', allocating if needed
+    void nextBlock(std::size_t minBytes) {
+        std::size_t next = _ptr ? _current + 1 : _current;
+        while (next < _blocks.size() && _blocks[next].size < minBytes) {
+            ++next;
+        }
+        if (next >= _blocks.size()) {
+            std::size_t size = minBytes > _blockSize ? minBytes : _blockSize;
+            _blocks.push_back(Block{static_cast<char*>(::operator new(size)), size});
+            next = _blocks.size() - 1;
+        }
+        _current = next;
+        _ptr = _blocks[next].data;
+        _end = _blocks[next].data + _blocks[next].size;
+    }
+
+    std::size_t _blockSize;
+    std::vector<Block> _blocks;
+    std::size_t _current;
+    char* _ptr;
+    char* _end;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "AST.h"
+#include "Arena.hpp"
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+// Tree node whose storage and child array live in an Arena.
+//
+// Children are still held by std::unique_ptr so the AbstractTreeNode
+// interface is unchanged, but deleting an ArenaTreeNode only runs its
+// destructor: the class-level operator delete gives nothing back, the
+// memory is reclaimed when the arena is reset.
+//
+// Children must be ArenaTreeNodes as well: an arena tree may be cleared
+// without visiting its nodes, which would leak a heap node hanging off it.
+// addChild() throws std::invalid_argument for any other node type.
+template <typename T>
+class ArenaTreeNode final : public AbstractTreeNode<T> {
+public:
+    ArenaTreeNode(Arena& arena, const T& value) : _value(value), _children(&arena) {}
+
+    // Allocation goes through the arena
+    static void* operator new(std::size_t size, Arena& arena) {
+        return arena.allocate(size, alignof(ArenaTreeNode));
+    }
+    static void operator delete(void*, Arena&) noexcept {}
+    static void operator delete(void*) noexcept {}
+
+    // Implementations of AbstractTreeNode<T> pure virtual methods
+    const T& getValue() const override {
+        return _value;
+    }
+
+    void setValue(const T& value) override {
+        _value = value;
+    }
+
+    void addChild(std::unique_ptr<AbstractTreeNode<T>> child) override {
+        if (child && typeid(*child) != typeid(ArenaTreeNode)) {
+            throw std::invalid_argument("ArenaTreeNode: children must be arena nodes");
+        }
+        _children.emplace_back(std::move(child));
+    }
+
+    std::span<const std::unique_ptr<AbstractTreeNode<T>>> getChildren() const override {
+        return _children;
+    }
+
+    bool removeChild(AbstractTreeNode<T>* child) override {
+        auto it = std::find_if(_children.begin(), _children.end(),
+            [&](const std::unique_ptr<AbstractTreeNode<T>>& ptr) {
+                return ptr.get() == child;
+            }
+        );
+
+        if (it != _children.end()) {
+            _children.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    void releaseChildren(std::vector<std::unique_ptr<AbstractTreeNode<T>>>& out) override {
+        for (auto& child : _children) {
+            out.emplace_back(std::move(child));
+        }
+        _children.clear();
+    }
+
+private:
+    T _value;
+    // Child array allocated from the same arena
+    std::pmr::vector<std::unique_ptr<AbstractTreeNode<T>>> _children;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Encoder.hpp"
+#include "SymbolTable.hpp"
+#include "Token.hpp"
+
+class Lexer;
+class ThreadPool;
+
+// Single-pass assembler over a Lexer token stream.
+//
+// Each line is "[label:] [instruction operands...]". Instructions are
+// matched against their operand pattern (one pass through the Encoder's
+// PatternAutomaton) and appended to a flat program
+// (InstructionRecords over one operand Token array) at 4 bytes each.
+//
+// Labels are resolved in the same pass. A reference to a label that is
+// already defined gets its value immediately. A forward reference is
+// recorded as a fixup on the label's pending list and patched when the
+// label is defined. Every reference is handled in O(1), and the token
+// stream is read only once.
+//
+// A label reference is a word in the immediate slot of a branch or jump
+// (isPcRelative(), Encoder.hpp), spelled as isLabelName() (Lexer.hpp)
+// requires. The lexer reports such words as TokenType::ERROR. They resolve
+// PC-relative (label address - instruction address). Other instructions
+// reject labels until %hi/%lo or absolute relocations exist.
+//
+// Errors are reported on std::cerr (or the stream given to setDiagnostics())
+// with their line and column. Assembly goes on after an error, so that one
+// run reports every problem.
+class Assembler {
+public:
+    explicit Assembler(const Encoder& encoder);
+
+    // Assemble everything the lexer produces; false if there were errors
+    bool assemble(Lexer& lexer);
+
+    // Encode the assembled program into 'out' (resized), in parallel on 'pool'
+    void encode(std::vector<std::uint32_t>& out, ThreadPool& pool) const;
+    void encode(std::vector<std::uint32_t>& out) const;
+
+    const std::vector<InstructionRecord>& instructions() const { return _instructions; }
+    const std::vector<Token>& operands() const { return _operands; }
+    const SymbolTable& symbols() const { return _symbols; }
+    std::size_t errorCount() const { return _errorCount; }
+
+    // Report errors to 'out' instead of std::cerr; it must outlive assemble()
+    void setDiagnostics(std::ostream& out) { _diagnostics = &out; }
+
+    // Drop the program and symbols but keep all capacity, for reuse
+    void reset();
+
+    // ------------------------
+    // Line checks
+    // ------------------------
+    // The validation and reporting assemble() uses, for other front ends
+    // (IncrementalAssembler) that keep their own program state. 'source' is
+    // the text the tokens' offsets point into: Lexer::source(), or a single
+    // line. Problems go to the diagnostics stream and count in errorCount().
+
+    // A line that starts with neither an instruction nor a label
+    void reportUnexpected(std::string_view source, const Token& token);
+
+    // Resolve 'instruction' to an Encoder id and check its operands against
+    // the pattern; on success 'labelMask' has a bit per operand that names a
+    // label. Reports the first problem and returns false otherwise.
+    bool checkInstruction(std::string_view source, const Token& instruction,
+                          std::span<const Token> operands,
+                          std::size_t& id, std::uint32_t& labelMask);
+
+    // Whether an immediate (or resolved label offset) fits encoding 'id'
+    bool checkImmediate(std::string_view source, const Token& operand, std::size_t id);
+
+    // Report any other problem at 'token'
+    void error(std::string_view source, const Token& token, const std::string& message);
+
+private:
+    struct Fixup {
+        std::uint32_t operand;      // Index in _operands
+        std::uint32_t instruction;  // Index in _instructions
+        std::uint32_t next;         // Next fixup of the same symbol, or npos
+    };
+    static constexpr std::uint32_t npos = UINT32_MAX;
+
+    std::size_t lookupInstruction(std::string_view source, const Token& token) const;
+    void assembleInstruction(std::string_view source, const Token& instruction,
+                             const std::vector<Token>& lineOperands);
+    void reportMismatch(std::string_view source, const Token& instruction, std::size_t id,
+                        std::span<const Token> lineOperands);
+    void defineLabel(std::string_view source, const Token& label);
+    bool resolveReference(std::string_view source, Token& operand, std::uint32_t operandIndex);
+
+    const Encoder& _encoder;
+    std::vector<std::size_t> _fromMnemonic;     // Encoder id per built-in mnemonic id
+
+    std::vector<InstructionRecord> _instructions;
+    std::vector<Token> _operands;
+    SymbolTable _symbols;
+    std::vector<std::uint32_t> _pendingHead;    // First unresolved fixup per symbol
+    std::vector<Fixup> _fixups;
+    std::vector<Token> _lineOperands;           // Scratch for the current line
+    std::ostream* _diagnostics;
+    std::size_t _errorCount;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Assembler.hpp"
+#include "Encoder.hpp"
+#include "SymbolTable.hpp"
+#include "Token.hpp"
+
+class Lexer;
+class ThreadPool;
+
+// Outcome of assembling one input file
+struct BatchResult {
+    std::string input;
+    std::vector<std::uint32_t> words;
+    SymbolTable symbols;        // Labels, for object file output
+    std::string diagnostics;    // Exactly what a single-file run reports
+    bool ok = false;
+};
+
+// Assembles many independent source files concurrently.
+//
+// The Encoder (the instruction set) is built once by the caller and shared
+// read-only by every file. Files are spread over the pool with one task per
+// file; each thread keeps its own Assembler (whose program, symbol and
+// fixup arrays keep their capacity) and diagnostics stream between files.
+// Token storage is not reused: the Lexer fills a std::deque, which frees
+// its blocks as tokens are consumed, so each file allocates its tokens
+// again, about one block per 32 tokens.
+//
+// Each file goes through the same Lexer + Assembler path as a single-file
+// run, and its diagnostics are captured per file instead of being written
+// to std::cerr, so concurrent files never interleave their messages.
+//
+// Sources are lexed with the built-in RV32I tables while the Encoder only
+// has RV32I mnemonics. A spec that adds instructions gets a Lexer built
+// from the Encoder's names; registers are then x0..x31 only.
+class BatchAssembler {
+public:
+    BatchAssembler(const Encoder& encoder, ThreadPool& pool);
+    ~BatchAssembler();
+
+    // Assemble every input; results come back in input order
+    std::vector<BatchResult> assemble(std::span<const std::string> inputs);
+
+    // Assemble one file with the calling thread's scratch
+    void assembleFile(const std::string& input, BatchResult& result);
+
+    // Read a manifest: one input path per line, blank lines and lines
+    // starting with '#' ignored. Relative paths are taken relative to the
+    // manifest's directory. False (with a message on std::cerr) if it
+    // cannot be read.
+    static bool readManifest(const std::string& manifestPath, std::vector<std::string>& inputs);
+
+private:
+    // Per-thread scratch, reused from file to file (the token deque only
+    // as an object; it does not keep its blocks)
+    struct Context {
+        explicit Context(const Encoder& encoder) : assembler(encoder) {
+            assembler.setDiagnostics(diagnostics);
+        }
+
+        std::deque<Token> tokens;
+        Assembler assembler;
+        std::ostringstream diagnostics;
+    };
+
+    void assembleTokens(Lexer& lexer, Context& context, BatchResult& result);
+
+    const Encoder& _encoder;
+    ThreadPool& _pool;
+    bool _customVocabulary;                         // Lex with the sets below
+    std::unordered_set<std::string> _instructions;  // The Encoder's names
+    std::unordered_set<std::string> _punctuation;
+    std::vector<std::unique_ptr<Context>> _contexts;   // One per pool thread, plus the caller
+};
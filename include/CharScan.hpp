@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+
+// Byte classes for the line scanner. Anything that is not a word character,
+// a parenthesis or a minus sign (spaces, commas, a lone ':') only separates
+// tokens.
+enum CharClass : unsigned char {
+    CC_SEPARATOR = 0,
+    CC_WORD,        // [a-zA-Z0-9_]
+    CC_PAREN,       // '(' or ')'
+    CC_NEWLINE,     // '\n'
+    CC_MINUS        // '-', starts a negative immediate
+};
+
+constexpr std::array<unsigned char, 256> makeCharClassTable() {
+    std::array<unsigned char, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = CC_WORD;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = CC_WORD;
+    for (int c = '0'; c <= '9'; ++c) table[c] = CC_WORD;
+    table['_'] = CC_WORD;
+    table['('] = CC_PAREN;
+    table[')'] = CC_PAREN;
+    table['\n'] = CC_NEWLINE;
+    table['-'] = CC_MINUS;
+    return table;
+}
+
+inline constexpr std::array<unsigned char, 256> charClassTable = makeCharClassTable();
+
+inline unsigned char charClassOf(char c) {
+    return charClassTable[static_cast<unsigned char>(c)];
+}
+
+// Run finders for the lexer's inner loop. On x86 they classify 16 (SSE2) or
+// 32 (AVX2) bytes per step, picked once at startup from the CPU features;
+// elsewhere they fall back to the scalar table above. Both return 'end'
+// when nothing is found.
+
+// First byte in [p, end) that is not a word character
+const char* findWordEnd(const char* p, const char* end);
+
+// First word character, parenthesis, minus sign or newline in [p, end)
+const char* findTokenStart(const char* p, const char* end);
+
+// Implementation picked at startup: "avx2", "sse2" or "scalar"
+const char* charScanImplementation();
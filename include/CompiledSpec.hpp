@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Reader.hpp"
+#include "Token.hpp"
+
+// Precompiled instruction spec.
+//
+// instructions.txt is parsed once (with the regex reader) into a flat binary
+// image and written to a cache file (by default in the user's cache
+// directory, see defaultCachePath()). Later runs map that image read-only
+// and use it in place: instruction names, pattern tokens and bit fields are
+// all served straight from the mapping, with no parsing and no allocation.
+//
+// Image layout (native endianness, every section 8-byte aligned):
+//   SpecHeader
+//   SpecInstruction[instructionCount]  sorted by name
+//   Token[tokenCount]                  pattern tokens of all instructions
+//   SpecField[fieldCount]              bit fields of all instructions
+//   char[stringBytes]                  names and bit-field text
+//
+// The header records the size and mtime of the source file and a checksum of
+// everything after the header. A cache that is stale, truncated, corrupt or
+// from another format version is rebuilt.
+
+struct SpecHeader {
+    char          magic[8];         // "NFSPEC\0\0"
+    std::uint32_t version;
+    std::uint32_t tokenSize;        // sizeof(Token) of the writer
+    std::uint64_t sourceSize;
+    std::int64_t  sourceMtimeNs;
+    std::uint32_t instructionCount;
+    std::uint32_t tokenCount;
+    std::uint32_t fieldCount;
+    std::uint32_t stringBytes;
+    std::uint64_t checksum;         // FNV-1a over the image after the header
+};
+
+struct SpecInstruction {
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t firstToken;
+    std::uint32_t tokenCount;
+    std::uint32_t firstField;
+    std::uint32_t fieldCount;
+};
+
+struct SpecField {
+    std::uint32_t bitCount;
+    std::uint32_t textOffset;
+    std::uint32_t textLength;
+};
+
+class CompiledSpec {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t npos = SIZE_MAX;
+
+    // Use 'cachePath' if it is up to date with 'specPath', otherwise parse
+    // 'specPath' and rewrite the cache. An empty cachePath means
+    // defaultCachePath(specPath). If the cache cannot be written the freshly
+    // built image is used from memory. Throws std::runtime_error if the spec
+    // itself cannot be read or parsed.
+    explicit CompiledSpec(const std::string& specPath, const std::string& cachePath = "");
+
+    // $XDG_CACHE_HOME/nanoforge/ (or ~/.cache/nanoforge/) plus a file name
+    // derived from the spec's absolute path, so specs never share a cache
+    // and nothing is written to the source tree or the working directory.
+    // Empty if neither variable is set; the spec is then compiled in memory.
+    static std::string defaultCachePath(const std::string& specPath);
+
+    CompiledSpec(const CompiledSpec&) = delete;
+    CompiledSpec& operator=(const CompiledSpec&) = delete;
+    CompiledSpec(CompiledSpec&&) noexcept = default;
+    CompiledSpec& operator=(CompiledSpec&&) noexcept = default;
+
+    // True if the image was mapped from an existing, valid cache
+    bool loadedFromCache() const { return _fromCache; }
+
+    std::size_t size() const { return _header->instructionCount; }
+
+    // Index of an instruction, or npos. Binary search over the sorted names.
+    std::size_t find(std::string_view name) const;
+
+    std::string_view name(std::size_t index) const;
+    std::span<const Token> tokens(std::size_t index) const;
+    std::span<const SpecField> fields(std::size_t index) const;
+    std::string_view fieldText(const SpecField& field) const;
+
+    // Build the same maps parseInstructionFile() fills
+    void toMaps(std::unordered_map<std::string, std::vector<Token>>& paramMap,
+                std::unordered_map<std::string, std::vector<BitField>>& binaryMap) const;
+
+    // Parse 'specPath' and serialize it; the image is returned in 'out'
+    static bool compile(const std::string& specPath, std::vector<std::byte>& out);
+
+private:
+    // Point the section pointers at 'data'; false if the image is unusable
+    bool attach(const std::byte* data, std::size_t size);
+
+    MappedFile _mapped;
+    std::vector<std::byte> _owned;      // Used when the cache could not be written
+    bool _fromCache;
+
+    const SpecHeader* _header;
+    const SpecInstruction* _instructions;
+    const Token* _tokens;
+    const SpecField* _fields;
+    const char* _strings;
+};
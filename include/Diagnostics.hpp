@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// What went wrong; each code has one message template (see Diagnostics.cpp)
+enum class DiagnosticCode : std::uint8_t {
+    EmptyTree,              // (warning)
+    InvalidNode,            // value
+    ArityMismatch,          // value, expected, actual
+    OperandKind,            // position, instruction, found
+    ExpectedInstruction,    // found
+    Count
+};
+
+// One recorded problem. Its arguments live in the owning Diagnostics.
+struct Diagnostic {
+    DiagnosticCode code;
+    std::uint8_t argCount;
+    std::uint32_t firstArg;
+    std::int32_t line;      // 0 if the problem has no source location
+    std::int32_t column;
+};
+
+// Collect-all diagnostics buffer.
+//
+// Checkers report every problem they find instead of printing the first
+// one and stopping. A report stores only its code, location and arguments;
+// text args are copied into one shared buffer, so reporting allocates only
+// when that buffer or the entry array grows. Messages are formatted when
+// they are written, normally once at the end of a run.
+//
+// An optional cap bounds the work spent on a hopeless input: once
+// 'maxErrors' diagnostics are recorded, report() returns false and the
+// caller should stop.
+class Diagnostics {
+public:
+    static constexpr std::size_t unlimited = 0;
+
+    explicit Diagnostics(std::size_t maxErrors = unlimited) : _maxErrors(maxErrors) {}
+
+    // Record a diagnostic; false once the cap is reached (the diagnostic
+    // that reaches it is still recorded, later ones are dropped)
+    template <typename... Args>
+    bool report(DiagnosticCode code, std::int32_t line, std::int32_t column, const Args&... args);
+
+    std::size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+    const std::vector<Diagnostic>& entries() const { return _entries; }
+
+    std::size_t maxErrors() const { return _maxErrors; }
+
+    // Whether the cap was reached, so checking stopped early
+    bool full() const { return _maxErrors != unlimited && _entries.size() >= _maxErrors; }
+
+    // Append everything 'other' recorded, in order and up to this buffer's
+    // cap. Lets parallel checks fill one buffer per task and merge them in
+    // a fixed order. False once the cap is reached.
+    bool append(const Diagnostics& other);
+
+    // Format one diagnostic, or all of them (one per line)
+    std::string format(const Diagnostic& diagnostic) const;
+    std::string str() const;
+
+    // Write everything in one go, noting a cap that was reached
+    void write(std::ostream& os) const;
+
+    // Forget everything, keeping the allocated capacity
+    void clear();
+
+private:
+    struct Arg {
+        bool isText;
+        std::int64_t number;
+        std::uint32_t offset;   // In _text, for text args
+        std::uint32_t length;
+    };
+
+    void addArg(std::string_view text);
+    void addArg(std::int64_t number) { _args.push_back(Arg{false, number, 0, 0}); }
+
+    template <typename T>
+    void add(const T& arg) {
+        if constexpr (std::is_integral_v<T>) {
+            addArg(static_cast<std::int64_t>(arg));
+        } else {
+            addArg(std::string_view(arg));
+        }
+    }
+
+    std::size_t _maxErrors;
+    std::vector<Diagnostic> _entries;
+    std::vector<Arg> _args;
+    std::string _text;
+};
+
+template <typename... Args>
+bool Diagnostics::report(DiagnosticCode code, std::int32_t line, std::int32_t column, const Args&... args) {
+    if (full()) {
+        return false;
+    }
+    _entries.push_back(Diagnostic{code, static_cast<std::uint8_t>(sizeof...(Args)),
+                                  static_cast<std::uint32_t>(_args.size()), line, column});
+    (add(args), ...);
+    return !full();
+}
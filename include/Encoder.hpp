@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ISA.hpp"
+#include "PatternAutomaton.hpp"
+#include "Reader.hpp"
+#include "Token.hpp"
+
+class CompiledSpec;
+class ThreadPool;
+
+// One operand contribution to an instruction word:
+//   word |= ((value >> srcShift) & mask) << dstShift
+struct EncodeStep {
+    std::uint8_t  operand;      // Index in the operand pattern
+    std::uint8_t  srcShift;     // Low bit of the source slice
+    std::uint8_t  dstShift;     // Position of the field in the word
+    std::uint32_t mask;         // Width of the field, as a low-bit mask
+};
+
+// A compiled encoding: the constant bits folded into one word, plus one step
+// per register or immediate field. Encoding an instruction is a handful of
+// shifts, ANDs and ORs with no branches on field kinds.
+struct Encoding {
+    static constexpr std::size_t kMaxSteps = 8;
+
+    std::uint32_t fixedBits = 0;
+    std::uint8_t  stepCount = 0;
+    std::uint8_t  immediateHi = 0;      // Highest immediate bit used
+    std::uint8_t  immediateLo = 0;      // Lowest immediate bit used
+    bool          hasImmediate = false;
+    bool          valid = false;        // False if the layout could not be compiled
+    std::array<EncodeStep, kMaxSteps> steps{};
+};
+
+// Fold a field layout (most significant field first) into an Encoding
+constexpr Encoding compileEncoding(std::span<const isa::FieldLayout> fields) {
+    Encoding out;
+    int position = 32;
+    for (const isa::FieldLayout& field : fields) {
+        position -= field.bitCount;
+        if (position < 0) {
+            return Encoding{};
+        }
+        std::uint32_t mask = field.bitCount >= 32 ? 0xFFFFFFFFu : ((1u << field.bitCount) - 1u);
+
+        if (field.kind == isa::FieldKind::Constant) {
+            out.fixedBits |= (field.constant & mask) << position;
+            continue;
+        }
+        if (out.stepCount == Encoding::kMaxSteps) {
+            return Encoding{};
+        }
+        EncodeStep& step = out.steps[out.stepCount++];
+        step.operand = field.operand;
+        step.srcShift = field.kind == isa::FieldKind::Immediate ? field.lo : 0;
+        step.dstShift = static_cast<std::uint8_t>(position);
+        step.mask = mask;
+
+        if (field.kind == isa::FieldKind::Immediate) {
+            if (!out.hasImmediate || field.hi > out.immediateHi) out.immediateHi = field.hi;
+            if (!out.hasImmediate || field.lo < out.immediateLo) out.immediateLo = field.lo;
+            out.hasImmediate = true;
+        }
+    }
+    out.valid = (position == 0);
+    return out.valid ? out : Encoding{};
+}
+
+// Compile every instruction of a generated table (see ISATables.hpp)
+template <std::size_t N, std::size_t F>
+constexpr std::array<Encoding, N> compileEncodings(const std::array<isa::InstructionInfo, N>& instructions,
+                                                   const std::array<isa::FieldLayout, F>& fields) {
+    std::array<Encoding, N> out{};
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = compileEncoding(std::span<const isa::FieldLayout>(
+            fields.data() + instructions[i].firstField, instructions[i].fieldCount));
+    }
+    return out;
+}
+
+// Operand values are indexed like the operand pattern; punctuation slots are
+// ignored
+constexpr std::uint32_t encode(const Encoding& encoding, const std::int32_t* values) {
+    std::uint32_t word = encoding.fixedBits;
+    for (std::size_t i = 0; i < encoding.stepCount; ++i) {
+        const EncodeStep& step = encoding.steps[i];
+        std::uint32_t value = static_cast<std::uint32_t>(values[step.operand]);
+        word |= ((value >> step.srcShift) & step.mask) << step.dstShift;
+    }
+    return word;
+}
+
+// Same, reading Token::value of the lexed operands (the tokens following the
+// instruction, which line up with its pattern)
+inline std::uint32_t encode(const Encoding& encoding, std::span<const Token> operands) {
+    std::uint32_t word = encoding.fixedBits;
+    for (std::size_t i = 0; i < encoding.stepCount; ++i) {
+        const EncodeStep& step = encoding.steps[i];
+        std::uint32_t value = static_cast<std::uint32_t>(operands[step.operand].value);
+        word |= ((value >> step.srcShift) & step.mask) << step.dstShift;
+    }
+    return word;
+}
+
+// True if 'value' survives encoding: the bits below the lowest slice are
+// zero and the value fits the slices, read as signed or unsigned
+constexpr bool immediateFits(const Encoding& encoding, std::int64_t value) {
+    if (!encoding.hasImmediate) {
+        return true;
+    }
+    std::int64_t alignment = std::int64_t{1} << encoding.immediateLo;
+    if (value % alignment != 0) {
+        return false;
+    }
+    std::int64_t limit = std::int64_t{1} << encoding.immediateHi;
+    return value >= -limit && value < 2 * limit;
+}
+
+// True for branch and jump encodings (B- and J-type): their offsets count
+// halfwords, so the immediate starts at bit 1. Only these take labels, which
+// resolve to label address - instruction address.
+constexpr bool isPcRelative(const Encoding& encoding) {
+    return encoding.hasImmediate && encoding.immediateLo == 1;
+}
+
+// One instruction of a resolved program: which encoding to use and where its
+// operands start in the program's operand array
+struct InstructionRecord {
+    std::uint32_t id;               // Encoder id
+    std::uint32_t firstOperand;
+};
+
+// Encoder for an instruction set: the one compiled into the binary
+// (builtin()), or one known only at run time (parsed or cached spec).
+// Instructions get dense ids in the order they are added.
+class Encoder {
+public:
+    static constexpr std::size_t npos = SIZE_MAX;
+
+    Encoder() = default;
+    Encoder(const std::unordered_map<std::string, std::vector<Token>>& paramMap,
+            const std::unordered_map<std::string, std::vector<BitField>>& binaryMap);
+    explicit Encoder(const CompiledSpec& spec);
+
+    // The instruction set generated from instructions.txt at build time
+    // (ISATables.hpp). Its encodings are compiled at compile time, so no
+    // spec is read or parsed; ids follow isa::Opcode.
+    static Encoder builtin();
+
+    // Compile one instruction; false (with a message on std::cerr) if a
+    // field is malformed or the fields do not cover exactly 32 bits
+    bool addInstruction(std::string_view name, std::span<const Token> pattern,
+                        std::span<const BitField> fields);
+
+    std::size_t size() const { return _encodings.size(); }
+    std::size_t find(std::string_view name) const;
+    std::string_view name(std::size_t id) const { return _names[id]; }
+
+    // True if every instruction is a base RV32I mnemonic, so sources can be
+    // lexed with the Lexer's built-in tables. A spec that adds instructions
+    // needs a Lexer built from its names instead.
+    bool builtinMnemonicsOnly() const;
+    const Encoding& encoding(std::size_t id) const { return _encodings[id]; }
+
+    // Operand pattern the encoding was compiled against
+    std::span<const Token> pattern(std::size_t id) const {
+        return std::span<const Token>(_patterns.data() + _patternRanges[id].first,
+                                      _patternRanges[id].second);
+    }
+
+    // All operand patterns compiled into one automaton (see
+    // PatternAutomaton.hpp); match(id, operands) validates a line's operands
+    const PatternAutomaton& automaton() const { return _automaton; }
+
+    std::uint32_t encode(std::size_t id, std::span<const Token> operands) const {
+        return ::encode(_encodings[id], operands);
+    }
+
+    // Encode a whole program (labels already resolved) into 'out', one word
+    // per instruction; out.size() must equal instructions.size(). Every word
+    // depends only on its own record, so ranges of the program are encoded
+    // concurrently on 'pool', each straight into its slice of 'out'.
+    void encodeAll(std::span<const InstructionRecord> instructions,
+                   std::span<const Token> operands,
+                   std::span<std::uint32_t> out,
+                   ThreadPool& pool) const;
+    void encodeAll(std::span<const InstructionRecord> instructions,
+                   std::span<const Token> operands,
+                   std::span<std::uint32_t> out) const;
+
+private:
+    bool addLayout(std::string_view name, std::span<const Token> pattern,
+                   std::span<const isa::FieldLayout> layout);
+    bool addEncoding(std::string_view name, std::span<const Token> pattern,
+                     const Encoding& encoding);
+
+    // Lets find() look up a string_view without building a std::string
+    struct NameHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::vector<Encoding> _encodings;
+    std::vector<std::string> _names;                // Per id
+    std::vector<Token> _patterns;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _patternRanges;   // (first, count) per id
+    std::unordered_map<std::string, std::size_t, NameHash, std::equal_to<>> _ids;
+    PatternAutomaton _automaton;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "AST.h"
+#include "ASTFactory.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Flat, index-based tree stored as parallel arrays (structure of arrays):
+// node kind, value id, first child and next sibling. Values are interned so
+// equal values share one id and are stored once.
+//
+// Nodes are numbered in insertion order. Trees built with flatten() (or by
+// adding every node after its parent, depth first) are therefore stored in
+// pre-order, and a plain loop over [0, size()) is a pre-order walk: no
+// virtual calls, no pointer chasing, no stack.
+template <typename T>
+class FlatTree {
+public:
+    using NodeId = std::uint32_t;
+    static constexpr NodeId npos = UINT32_MAX;
+
+    // Append a node under 'parent' (npos for the root, which must be the
+    // first node) and return its id
+    NodeId addNode(const T& value, NodeId parent = npos, std::uint16_t kind = 0) {
+        NodeId id = static_cast<NodeId>(_kind.size());
+        _kind.push_back(kind);
+        _valueId.push_back(intern(value));
+        _firstChild.push_back(npos);
+        _nextSibling.push_back(npos);
+        _lastChild.push_back(npos);
+
+        if (parent != npos) {
+            if (_lastChild[parent] == npos) {
+                _firstChild[parent] = id;
+            } else {
+                _nextSibling[_lastChild[parent]] = id;
+            }
+            _lastChild[parent] = id;
+        }
+        return id;
+    }
+
+    void reserve(std::size_t nodes) {
+        _kind.reserve(nodes);
+        _valueId.reserve(nodes);
+        _firstChild.reserve(nodes);
+        _nextSibling.reserve(nodes);
+        _lastChild.reserve(nodes);
+    }
+
+    void clear() {
+        _kind.clear();
+        _valueId.clear();
+        _firstChild.clear();
+        _nextSibling.clear();
+        _lastChild.clear();
+        _values.clear();
+        _valueIds.clear();
+    }
+
+    std::size_t size() const { return _kind.size(); }
+    bool empty() const { return _kind.empty(); }
+    NodeId root() const { return empty() ? npos : 0; }
+
+    std::uint16_t kind(NodeId id) const { return _kind[id]; }
+    std::uint32_t valueId(NodeId id) const { return _valueId[id]; }
+    const T& value(NodeId id) const { return _values[_valueId[id]]; }
+    NodeId firstChild(NodeId id) const { return _firstChild[id]; }
+    NodeId nextSibling(NodeId id) const { return _nextSibling[id]; }
+
+    std::size_t childCount(NodeId id) const {
+        std::size_t count = 0;
+        for (NodeId c = _firstChild[id]; c != npos; c = _nextSibling[c]) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Distinct values, indexed by value id
+    const std::vector<T>& values() const { return _values; }
+
+private:
+    std::uint32_t intern(const T& value) {
+        auto [it, inserted] = _valueIds.try_emplace(value, static_cast<std::uint32_t>(_values.size()));
+        if (inserted) {
+            _values.push_back(value);
+        }
+        return it->second;
+    }
+
+    std::vector<std::uint16_t> _kind;
+    std::vector<std::uint32_t> _valueId;
+    std::vector<NodeId> _firstChild;
+    std::vector<NodeId> _nextSibling;
+    std::vector<NodeId> _lastChild;     // Only needed while appending
+    std::vector<T> _values;
+    std::unordered_map<T, std::uint32_t> _valueIds;
+};
+
+// ------------------------
+// Adapters
+// ------------------------
+
+// Copy a pointer-based tree into a FlatTree, in pre-order
+template <typename T>
+FlatTree<T> flatten(const AbstractTree<T>& tree) {
+    using NodeId = typename FlatTree<T>::NodeId;
+    FlatTree<T> flat;
+    if (!tree.getRoot()) {
+        return flat;
+    }
+
+    // Explicit stack of (node, flat parent); children pushed in reverse so
+    // they come out in order
+    std::vector<std::pair<const AbstractTreeNode<T>*, NodeId>> stack;
+    stack.emplace_back(tree.getRoot(), FlatTree<T>::npos);
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+
+        NodeId id = flat.addNode(node->getValue(), parent);
+        auto children = node->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.emplace_back(it->get(), id);
+        }
+    }
+    return flat;
+}
+
+// Rebuild a pointer-based SyntaxTree (through ASTFactory) from a FlatTree
+template <typename T>
+AbstractTree<T>* expand(const FlatTree<T>& flat) {
+    AbstractTree<T>* tree = ASTFactory<T>::createTree();
+    if (flat.empty()) {
+        return tree;
+    }
+
+    // Create every node first, then hand each one its children in sibling
+    // order
+    std::vector<AbstractTreeNode<T>*> nodes(flat.size());
+    for (std::size_t i = 0; i < flat.size(); ++i) {
+        nodes[i] = ASTFactory<T>::createNode(flat.value(static_cast<typename FlatTree<T>::NodeId>(i)));
+    }
+    for (std::size_t i = 0; i < flat.size(); ++i) {
+        auto id = static_cast<typename FlatTree<T>::NodeId>(i);
+        for (auto c = flat.firstChild(id); c != FlatTree<T>::npos; c = flat.nextSibling(c)) {
+            nodes[i]->addChild(std::unique_ptr<AbstractTreeNode<T>>(nodes[c]));
+        }
+    }
+    tree->setRoot(nodes[flat.root()]);
+    return tree;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "Token.hpp"
+
+// Plain-data description of an instruction set, in the shape emitted by the
+// spec generator (nanoforge_specgen) into ISATables.hpp. Everything here is a
+// literal type, so generated tables are constexpr.
+namespace isa {
+
+// One operand slot of an instruction pattern
+struct OperandPattern {
+    TokenType type;
+    char punctuation;       // Only for TokenType::PUNCTUATION
+};
+
+enum class FieldKind : std::uint8_t {
+    Constant,   // Fixed bits, e.g. an opcode or funct3
+    Register,   // Register number of an operand
+    Immediate   // Bits [hi:lo] of an immediate operand
+};
+
+// One bit field of an encoding, most significant field first
+struct FieldLayout {
+    std::uint8_t  bitCount;
+    FieldKind     kind;
+    std::uint8_t  operand;  // Index in the operand pattern (Register, Immediate)
+    std::uint8_t  hi;       // Source slice of the immediate (Immediate)
+    std::uint8_t  lo;
+    std::uint32_t constant; // Field value (Constant)
+};
+
+struct InstructionInfo {
+    std::string_view name;
+    std::uint16_t firstOperand;
+    std::uint16_t operandCount;
+    std::uint16_t firstField;
+    std::uint16_t fieldCount;
+};
+
+// Resolve the text of a BitField against an operand pattern:
+//   "0110011"         constant bits (exactly bitCount binary digits)
+//   "registerN"       the N-th (1-based) register operand
+//   "immediate(H:L)"  bits H..L of the immediate operand
+//   "immediate"       the low bitCount bits of the immediate operand
+// Returns false if the text is malformed or names a missing operand.
+bool resolveField(std::string_view text, int bitCount,
+                  std::span<const Token> pattern, FieldLayout& out);
+
+} // namespace isa
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Assembler.hpp"
+#include "Encoder.hpp"
+#include "SymbolTable.hpp"
+#include "Token.hpp"
+
+// Assembler that keeps per-line state between runs and only redoes the work
+// for lines that changed.
+//
+// For every source line it remembers a hash of the text, the line's tokens
+// (offsets relative to the line start) and which instruction it holds; the
+// program's encoded words are kept alongside, with per-line prefix sums
+// (first token, instruction index) and an index of label definitions and
+// references by line. A new run:
+//   1. hashes the new source line by line and finds the changed region as
+//      the lines between the longest common prefix and suffix,
+//   2. re-lexes and re-assembles only that region and splices it in; the
+//      arrays move their tails only when the region changed size, and prefix
+//      sums and index entries after the region are shifted, not rebuilt,
+//   3. re-resolves the region's label references. Only if the edit moved
+//      code or labels relative to each other (the instruction count or a
+//      label's address changed) are all references checked, and then only
+//      those whose PC-relative offset actually changed are re-encoded.
+// Lexing, label interning and encoding are proportional to the edit; the
+// rest is at most a shift of the entries after it.
+//
+// State can be saved to and loaded from a cache file (conventionally next
+// to the output, see cachePathFor()). Caches from another format version or
+// another instruction set are ignored and trigger a full build. Only
+// error-free states are saved.
+//
+// Lines are checked by an Assembler, so problems are reported with the same
+// messages as a full build, on std::cerr or the stream given to
+// setDiagnostics().
+//
+// Sources are lexed with the built-in RV32I vocabulary.
+class IncrementalAssembler {
+public:
+    explicit IncrementalAssembler(const Encoder& encoder);
+
+    // Assemble 'source', reusing the current state; false if there were
+    // errors. After an error the next run is a full build.
+    bool assemble(std::string_view source);
+
+    // Report errors to 'out' instead of std::cerr; it must outlive assemble()
+    void setDiagnostics(std::ostream& out) { _checker.setDiagnostics(out); }
+
+    const std::vector<std::uint32_t>& words() const { return _words; }
+
+    // Fill 'out' with the labels of the last successful run, in the order a
+    // full build interns them, with their addresses (for ObjectWriter)
+    void exportSymbols(SymbolTable& out) const;
+
+    // Work done by the last assemble()
+    std::size_t linesRelexed() const { return _linesRelexed; }
+    std::size_t wordsEncoded() const { return _wordsEncoded; }
+
+    // Load state saved by save(); false (and an empty state) if the cache is
+    // missing, corrupt, or was made for another instruction set
+    bool load(const std::string& cachePath);
+    bool save(const std::string& cachePath) const;
+
+    static std::string cachePathFor(const std::string& outputPath) {
+        return outputPath + ".nfinc";
+    }
+
+private:
+    enum LineFlags : std::uint8_t {
+        HasInstruction = 1,
+        HasReference   = 2     // Some operand names a label
+    };
+
+    // A label definition or reference: token 'token' of line 'line'
+    struct LabelUse {
+        std::uint32_t line;
+        std::uint32_t token;
+        SymbolTable::SymbolId symbol;
+    };
+    using LabelUses = std::vector<LabelUse>;
+
+    struct LineRecord {
+        std::uint64_t hash;
+        std::uint32_t encoderId;        // Valid with HasInstruction
+        std::uint16_t tokenCount;       // Tokens of the line, without EoL
+        std::uint8_t  instructionToken; // Index of the instruction in the line's tokens
+        std::uint8_t  flags;
+    };
+    static_assert(sizeof(LineRecord) == 16, "LineRecord is stored verbatim in the cache");
+
+    // Lex and assemble lines [first, first + count) of the new source into
+    // the given output vectors
+    bool assembleRegion(std::string_view source, const std::vector<std::uint32_t>& lineStarts,
+                        std::size_t first, std::size_t count,
+                        std::vector<LineRecord>& lines, std::vector<Token>& tokens,
+                        std::vector<std::uint32_t>& words);
+    // 'lineTokens' carry their line number while they are checked
+    bool assembleLine(std::string_view line, LineRecord& record,
+                      std::span<Token> lineTokens, std::vector<std::uint32_t>& words);
+    bool resolveLabels(std::string_view source,
+                       LabelUses::const_iterator first, LabelUses::const_iterator last,
+                       std::size_t regionBegin, std::size_t regionEnd);
+
+    // Label index maintenance
+    void indexLines(std::string_view source, std::size_t first, std::size_t last,
+                    LabelUses& definitions, LabelUses& references);
+    void reindexRegion(std::string_view source, std::size_t first, std::size_t oldEnd,
+                       std::size_t count, std::uint32_t lineDelta);
+    void reindexAll(std::string_view source);
+    void defineLabel(std::string_view source, const LabelUse& definition);
+    static std::pair<LabelUses::iterator, LabelUses::iterator>
+    lineRange(LabelUses& uses, std::size_t firstLine, std::size_t lastLine);
+
+    std::string_view lineText(std::string_view source, std::size_t line) const;
+    void clearState();
+    std::uint64_t fingerprint() const;
+
+    const Encoder& _encoder;
+    std::uint64_t _fingerprint;
+    bool _valid;
+    Assembler _checker;     // Line checks and diagnostics, shared with full builds
+
+    std::vector<LineRecord> _lines;
+    std::vector<Token> _tokens;
+    std::vector<std::uint32_t> _words;
+
+    std::vector<std::uint32_t> _lineToken;  // First token of each line, then the total
+    std::vector<std::uint32_t> _lineWord;   // Instruction index of each line, then the total
+
+    // Label index. Built from the source text, so after load() the next run
+    // builds it from scratch.
+    SymbolTable _symbols;                   // Names seen since the last full build
+    LabelUses _labels;                      // Definition per symbol; line npos if undefined
+    LabelUses _definitions;                 // In line order
+    LabelUses _references;                  // In line order
+    bool _indexed;
+
+    // Scratch reused between runs
+    std::vector<std::uint64_t> _hashes;
+    std::vector<std::uint32_t> _lineStarts;
+
+    std::size_t _linesRelexed;
+    std::size_t _wordsEncoded;
+};
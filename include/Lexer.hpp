@@ -1,34 +1,136 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include "Token.hpp"
 
+class MappedFile;
+
+namespace rv32i {
+struct Symbol;
+}
+
+// True if 'name' can name a label: an ASCII letter, then letters and
+// digits. The lexer applies it to definitions ("name:"), the assemblers and
+// the syntax checker to references in operand slots.
+bool isLabelName(std::string_view name);
+
+enum class LexMode {
+    Eager,      // Tokenize the whole source in the constructor
+    Streaming,  // Tokenize one line at a time as tokens are consumed
+    Parallel    // Tokenize chunks of lines concurrently in the constructor
+};
+
 class Lexer {
 public:
-    // Constructor
+    // Constructors
+    // In LexMode::Streaming, parsedFileRef only holds a bounded window (the
+    // rest of the current line) and is refilled by hasMoreTokens(),
+    // peekNextToken() and getNextToken(). Paired with a MappedFile this
+    // lexes arbitrarily large sources in constant memory.
+    //
+    // LexMode::Parallel produces the same tokens as LexMode::Eager, but lexes
+    // the source in newline-aligned chunks on ThreadPool::shared(). Sources
+    // under a few hundred KiB are lexed sequentially.
+    //
+    // Reads the whole stream into an internal buffer, then scans it
     Lexer(std::ifstream& source,
           std::deque<Token>& parsedFileRef,
           const std::unordered_set<std::string>& instructionsSet,
-          const std::unordered_set<std::string>& punctuationSet);
+          const std::unordered_set<std::string>& punctuationSet,
+          LexMode lexMode = LexMode::Eager);
+
+    // Scans 'source' in place; the caller keeps the buffer alive
+    Lexer(std::string_view source,
+          std::deque<Token>& parsedFileRef,
+          const std::unordered_set<std::string>& instructionsSet,
+          const std::unordered_set<std::string>& punctuationSet,
+          LexMode lexMode = LexMode::Eager);
+
+    // Scans a memory-mapped file in place
+    Lexer(const MappedFile& source,
+          std::deque<Token>& parsedFileRef,
+          const std::unordered_set<std::string>& instructionsSet,
+          const std::unordered_set<std::string>& punctuationSet,
+          LexMode lexMode = LexMode::Eager);
+
+    // Same, but classify words with the built-in RV32I tables (RV32I.hpp):
+    // base mnemonics, x0..x31 and ABI register names. The set-based
+    // constructors above remain for custom instruction sets; they classify
+    // only x0..x31 as registers, so ABI names there stay ERROR tokens.
+    Lexer(std::ifstream& source,
+          std::deque<Token>& parsedFileRef,
+          LexMode lexMode = LexMode::Eager);
+    Lexer(std::string_view source,
+          std::deque<Token>& parsedFileRef,
+          LexMode lexMode = LexMode::Eager);
+    Lexer(const MappedFile& source,
+          std::deque<Token>& parsedFileRef,
+          LexMode lexMode = LexMode::Eager);
+
+    // Tokens point into the source buffer, which may be owned by the Lexer
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
 
     // Token consumption functions
     bool hasMoreTokens() const;
     const Token& peekNextToken() const;
     Token getNextToken();
 
+    // Materialize a token's text / column from the source buffer
+    std::string_view lexeme(const Token& token) const;
+    int column(const Token& token) const;
+
+    // The buffer every token's offset points into
+    std::string_view source() const { return sourceBuffer; }
+
     // Function to print all tokens (optional, for debugging)
     void printTokens() const;
 
 private:
-    int currentLine;
-    int currentColumn;
+    mutable int currentLine;
     std::deque<Token>& parsedFile;                           
-    const std::unordered_set<std::string>& instructions;     
-    const std::unordered_set<std::string>& punctuations; 
+    const std::unordered_set<std::string>* instructions;    // nullptr: built-in RV32I
+    const std::unordered_set<std::string>* punctuations;    // tables (RV32I.hpp)
+    std::string ownedSource;    // Backing buffer for the ifstream constructor
+    LexMode mode;
+    std::string_view sourceBuffer;
+    mutable std::uint32_t scanPos = 0;  // Start of the next unscanned line
+    mutable bool eofEmitted = false;
+
+    // Shared by the constructors: members only, nothing scanned yet
+    Lexer(std::deque<Token>& parsedFileRef,
+          const std::unordered_set<std::string>* instructionsSet,
+          const std::unordered_set<std::string>* punctuationSet,
+          LexMode lexMode);
+
+    // Read a whole stream into ownedSource and point sourceBuffer at it
+    void readStream(std::ifstream& source);
+
+    // Split the source buffer into lines and scan each one (eager mode)
+    void scanBuffer();
+    bool scanNextLine() const;
+    void fillWindow() const;
+    void scanParallel();
+
+    std::uint32_t offsetOf(const char* p) const {
+        return static_cast<std::uint32_t>(p - sourceBuffer.data());
+    }
+
+    // Scan one line and append its tokens (and EoL) to 'out'; returns the
+    // start of the next line
+    template <typename Container>
+    const char* scanLine(const char* line, const char* end, int lineNo, Container& out) const;
+
+    // Word classification helpers for tokenize()
+    bool builtinWords() const;
+    bool isPunctuation(std::string_view word) const;
+    bool isInstruction(std::string_view word, const rv32i::Symbol* symbol) const;
 
     // Tokenization function
-    Token tokenize(const char* str, size_t length, int line, int column);
+    Token tokenize(const char* str, size_t length, int line) const;
 };
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Key for looking a word up in the std::string-keyed tables of a custom
+// instruction set (the Lexer's sets, the SyntaxChecker's paramMap). The
+// buffer is reused per thread, so a lookup allocates only when a word
+// outgrows every word before it on that thread; parallel lexing and pool
+// checks look words up from several threads. Valid until the next call on
+// the same thread.
+inline const std::string& lookupKey(std::string_view word) {
+    thread_local std::string key;
+    key.assign(word.data(), word.size());
+    return key;
+}
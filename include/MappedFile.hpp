@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object; views handed out by view() must not outlive it.
+class MappedFile {
+public:
+    // Empty mapping
+    MappedFile() : _data(nullptr), _size(0) {}
+    // Map 'path' into memory; throws std::runtime_error on failure
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return _data; }
+    std::size_t size() const { return _size; }
+    std::string_view view() const { return std::string_view(_data, _size); }
+
+private:
+    void unmap();
+
+    const char* _data;
+    std::size_t _size;
+};
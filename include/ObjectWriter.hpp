@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class SymbolTable;
+
+// Output stage: turns encoded instruction words into a file.
+//
+// Two formats:
+//   Binary  raw little-endian instruction words, nothing else
+//   Elf     minimal relocatable ELF32 RISC-V object: .text (the words),
+//           an empty .data, and .symtab/.strtab with every label as a
+//           local symbol at its .text offset
+//
+// build() lays the file out in one preallocated buffer, reused from file
+// to file. The instruction words are not copied on little-endian hosts:
+// write() hands the buffer and the caller's word array to a single
+// writev(), so the words must stay alive and unchanged until then.
+//
+// No relocations are emitted: the assembler resolves every label reference
+// PC-relative within the file and rejects undefined labels, so an object
+// never refers to anything outside itself.
+class ObjectWriter {
+public:
+    enum class Format {
+        Binary,
+        Elf
+    };
+
+    explicit ObjectWriter(Format format = Format::Binary) : _format(format), _tailOffset(0) {}
+
+    Format format() const { return _format; }
+
+    // Lay out a file for 'words'. 'symbols' names the labels (ELF only;
+    // undefined symbols are skipped).
+    void build(std::span<const std::uint32_t> words, const SymbolTable* symbols = nullptr);
+
+    // Size of the laid-out file
+    std::size_t size() const;
+
+    // The laid-out file as one contiguous byte array
+    std::vector<char> bytes() const;
+
+    // Write the laid-out file to 'path' (created or truncated) with one
+    // writev(). False on failure, with errno set.
+    bool write(const std::string& path) const;
+
+    // Usual file extension for the format: ".bin" or ".o"
+    const char* extension() const { return _format == Format::Elf ? ".o" : ".bin"; }
+
+private:
+    // The file is _buffer[0, _tailOffset) + text + _buffer[_tailOffset, end)
+    std::span<const char> head() const;
+    std::span<const char> text() const;
+    std::span<const char> tail() const;
+
+    void layoutElf(const SymbolTable* symbols);
+
+    Format _format;
+    std::span<const std::uint32_t> _words;
+    std::vector<char> _textBytes;       // Byte-swapped words, big-endian hosts only
+    std::vector<char> _buffer;          // ELF header, then everything after .text
+    std::size_t _tailOffset;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Token.hpp"
+
+// Deterministic automaton over the operand patterns of an instruction set.
+//
+// Every pattern (register, immediate, punctuation '(' ...) is inserted into
+// one trie whose edges are labelled with token classes: register,
+// immediate, label definition, each punctuation character in use, and
+// "word" (an unclassified token, i.e. a possible label reference). The word
+// edge follows every immediate edge, so patterns sharing a prefix still
+// share states; whether an instruction actually takes labels in its
+// immediate slots is kept per id. Each instruction id remembers the state
+// its own pattern ends in.
+//
+// Matching a line is one table lookup per operand token: no backtracking,
+// no per-pattern comparisons and no string work. The line matches iff the
+// walk ends in the instruction's accept state and words appear only in
+// slots where the instruction takes labels.
+class PatternAutomaton {
+public:
+    using StateId = std::uint16_t;
+    static constexpr StateId dead = UINT16_MAX;
+    static constexpr std::size_t maxOperands = 32;     // Bits of Match::labelMask
+
+    struct Match {
+        bool ok;
+        std::uint32_t labelMask;    // Operands matched as possible label references
+    };
+
+    PatternAutomaton();
+
+    // Set (or replace) the pattern of instruction 'id'; with 'takesLabels'
+    // its immediate slots also accept words. False if the pattern is too
+    // long, uses too many distinct punctuation characters, or the automaton
+    // ran out of states.
+    bool add(std::size_t id, std::span<const Token> pattern, bool takesLabels = false);
+
+    Match match(std::size_t id, std::span<const Token> operands) const {
+        if (id >= _accept.size()) {
+            return Match{false, 0};
+        }
+        StateId state = 0;
+        std::uint32_t labelMask = 0;
+        for (std::size_t k = 0; k < operands.size(); ++k) {
+            std::uint8_t tokenClass = classOf(operands[k]);
+            if (tokenClass == noClass || (state = _next[state * kMaxClasses + tokenClass]) == dead) {
+                return Match{false, 0};
+            }
+            if (tokenClass == Word) {
+                labelMask |= 1u << k;
+            }
+        }
+        return Match{state == _accept[id] && (labelMask & ~_labelSlots[id]) == 0, labelMask};
+    }
+
+    std::size_t stateCount() const { return _next.size() / kMaxClasses; }
+
+private:
+    enum TokenClass : std::uint8_t {
+        Register,
+        Immediate,
+        Label,
+        Word,
+        FirstPunctuation        // One class per punctuation character in use
+    };
+    static constexpr std::size_t kMaxClasses = 16;
+    static constexpr std::uint8_t noClass = UINT8_MAX;
+
+    std::uint8_t classOf(const Token& token) const {
+        switch (token.type) {
+            case TokenType::REGISTER:    return Register;
+            case TokenType::IMMEDIATE:   return Immediate;
+            case TokenType::LABEL:       return Label;
+            case TokenType::ERROR:       return Word;
+            case TokenType::PUNCTUATION: return _punctuationClass[static_cast<std::uint8_t>(token.value)];
+            default:                     return noClass;
+        }
+    }
+
+    // Follow (or create) the edge for 'tokenClass' out of 'state'
+    StateId step(StateId state, std::uint8_t tokenClass);
+
+    std::vector<StateId> _next;         // stateCount() x kMaxClasses transitions
+    std::vector<StateId> _accept;       // Accept state per instruction id, or dead
+    std::vector<std::uint32_t> _labelSlots; // Operands that may be words, per instruction id
+    std::array<std::uint8_t, 256> _punctuationClass;
+    std::uint8_t _classCount;
+};
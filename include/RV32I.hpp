@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Built-in RV32I vocabulary: base-ISA mnemonics, x0..x31 and the ABI
+// register names. Everything is resolved at compile time into a perfect
+// hash table, so classifying a word is one hash, one probe and one compare.
+namespace rv32i {
+
+enum class SymbolKind : std::uint8_t {
+    Instruction,
+    Register
+};
+
+struct Symbol {
+    std::string_view name;
+    SymbolKind kind;
+    std::int32_t value;     // Mnemonic id (index in 'mnemonics') or register number
+};
+
+inline constexpr std::array<std::string_view, 37> mnemonics = {
+    "lui", "auipc", "jal", "jalr",
+    "beq", "bne", "blt", "bge", "bltu", "bgeu",
+    "lb", "lh", "lw", "lbu", "lhu", "sb", "sh", "sw",
+    "addi", "slti", "sltiu", "xori", "ori", "andi", "slli", "srli", "srai",
+    "add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and"
+};
+
+inline constexpr std::array<std::string_view, 32> registerNames = {
+    "x0",  "x1",  "x2",  "x3",  "x4",  "x5",  "x6",  "x7",
+    "x8",  "x9",  "x10", "x11", "x12", "x13", "x14", "x15",
+    "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23",
+    "x24", "x25", "x26", "x27", "x28", "x29", "x30", "x31"
+};
+
+// Indexed by register number
+inline constexpr std::array<std::string_view, 32> abiRegisterNames = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0",   "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6",   "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8",   "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+
+inline constexpr std::size_t kMinNameLength = 2;
+inline constexpr std::size_t kMaxNameLength = 6;
+
+// Seeded FNV-1a with a final avalanche step
+constexpr std::uint32_t hash(std::string_view s, std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+namespace detail {
+
+inline constexpr std::size_t kSymbolCount =
+    mnemonics.size() + registerNames.size() + abiRegisterNames.size() + 1;
+
+constexpr std::array<Symbol, kSymbolCount> makeSymbols() {
+    std::array<Symbol, kSymbolCount> out{};
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < mnemonics.size(); ++i) {
+        out[n++] = Symbol{mnemonics[i], SymbolKind::Instruction, static_cast<std::int32_t>(i)};
+    }
+    for (std::size_t i = 0; i < registerNames.size(); ++i) {
+        out[n++] = Symbol{registerNames[i], SymbolKind::Register, static_cast<std::int32_t>(i)};
+    }
+    for (std::size_t i = 0; i < abiRegisterNames.size(); ++i) {
+        out[n++] = Symbol{abiRegisterNames[i], SymbolKind::Register, static_cast<std::int32_t>(i)};
+    }
+    out[n++] = Symbol{"fp", SymbolKind::Register, 8};   // Frame pointer alias of s0
+    return out;
+}
+
+inline constexpr std::size_t kTableSize = 2048;     // Power of two
+
+struct Table {
+    std::uint32_t seed;
+    std::array<std::uint8_t, kTableSize> slots;     // Symbol index + 1, 0 = empty
+};
+
+// Try seeds until every symbol lands in its own slot
+constexpr Table buildTable(const std::array<Symbol, kSymbolCount>& symbols) {
+    for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+        Table table{seed, {}};
+        bool collision = false;
+        for (std::size_t i = 0; i < symbols.size() && !collision; ++i) {
+            auto slot = hash(symbols[i].name, seed) & (kTableSize - 1);
+            if (table.slots[slot] != 0) {
+                collision = true;
+            } else {
+                table.slots[slot] = static_cast<std::uint8_t>(i + 1);
+            }
+        }
+        if (!collision) {
+            return table;
+        }
+    }
+    return Table{0, {}};
+}
+
+} // namespace detail
+
+inline constexpr std::array<Symbol, detail::kSymbolCount> symbols = detail::makeSymbols();
+inline constexpr detail::Table table = detail::buildTable(symbols);
+
+static_assert(symbols.size() < 255, "Slot indices are stored in a byte");
+
+// Look up a mnemonic or register name; nullptr if it is neither
+constexpr const Symbol* lookup(std::string_view s) {
+    if (s.size() < kMinNameLength || s.size() > kMaxNameLength) {
+        return nullptr;
+    }
+    std::uint8_t index = table.slots[hash(s, table.seed) & (detail::kTableSize - 1)];
+    if (index == 0) {
+        return nullptr;
+    }
+    const Symbol& symbol = symbols[index - 1];
+    return symbol.name == s ? &symbol : nullptr;
+}
+
+namespace detail {
+
+constexpr bool everySymbolResolves() {
+    for (const Symbol& symbol : symbols) {
+        if (lookup(symbol.name) != &symbol) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+static_assert(detail::everySymbolResolves(),
+              "No collision-free seed found for the RV32I symbol table");
+
+} // namespace rv32i
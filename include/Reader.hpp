@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Token.hpp"
+
+//--------------------------------------------------------------
+// Data structure for bit fields
+//--------------------------------------------------------------
+struct BitField {
+    int bitCount;      // e.g. 5
+    std::string field; // e.g. "00101" or "register1"
+};
+
+// "register : any" -> Token pattern (see reader.cpp)
+Token parseParamStringToToken(const std::string& paramString);
+
+// "load : [register : any] [punctuation : ,] ..." -> name + pattern tokens
+bool parseParamLine(const std::string& line,
+                    std::string& outInstrName,
+                    std::vector<Token>& outTokens);
+
+// "[7 : 0000011] [5 : register1] ..." -> bit fields, most significant first
+bool parseBinaryLine(const std::string& line, std::vector<BitField>& outBitFields);
+
+// Read an instruction file as pairs of (param line, binary line)
+bool parseInstructionFile(const std::string& filename,
+                          std::unordered_map<std::string, std::vector<Token>>& paramMap,
+                          std::unordered_map<std::string, std::vector<BitField>>& binaryMap);
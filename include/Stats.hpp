@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Lightweight phase timers and counters.
+//
+// Instrumented code uses two macros:
+//   NF_STATS_PHASE(Lex);            // time the rest of the scope as 'Lex'
+//   NF_STATS_ADD(Tokens, count);    // bump a counter
+// Built with NANOFORGE_STATS=0 both expand to nothing and their arguments
+// are not evaluated.
+//
+// Phases are exclusive: a phase entered inside another pauses the outer
+// one, so the per-phase times add up to the instrumented total. Times and
+// counts are summed over all threads. Streaming lexing is interleaved with
+// its consumer and is timed as part of the consumer's phase.
+//
+// Allocations are counted only in binaries that link src/StatsAllocator.cpp
+// (the riscv_compiler driver), per phase of the allocating thread.
+#ifndef NANOFORGE_STATS
+#define NANOFORGE_STATS 0
+#endif
+
+namespace stats {
+
+enum class Phase : std::uint8_t {
+    SpecLoad,
+    Lex,
+    Check,
+    Assemble,
+    Encode,
+    Emit,
+    Count
+};
+
+enum class Counter : std::uint8_t {
+    Tokens,
+    Instructions,       // Assembled instructions
+    SpecInstructions,   // Instructions read from instruction specs
+    SyntaxNodes,        // Tree nodes checked (instructions + operands when streaming)
+    BytesRead,
+    BytesWritten,
+    Files,
+    Errors,
+    Allocations,
+    AllocatedBytes,
+    Count
+};
+
+const char* name(Phase phase);
+const char* name(Counter counter);
+
+// Whether this build records anything
+constexpr bool enabled = NANOFORGE_STATS != 0;
+
+// Write everything recorded so far as one JSON object. 'wallNs' is the
+// caller's end-to-end time, reported next to the phase totals.
+void writeJson(std::ostream& os, std::uint64_t wallNs);
+
+#if NANOFORGE_STATS
+
+struct alignas(64) PhaseTotals {
+    std::atomic<std::uint64_t> ns{0};
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> allocations{0};
+};
+
+// Each total on its own cache line, so threads bumping different ones do
+// not contend
+struct alignas(64) CounterTotal {
+    std::atomic<std::uint64_t> value{0};
+};
+
+// Constant-initialized, so it is usable from operator new at any time
+struct Registry {
+    PhaseTotals phases[static_cast<std::size_t>(Phase::Count)];
+    CounterTotal counters[static_cast<std::size_t>(Counter::Count)];
+    std::atomic<bool> allocationsTracked{false};
+};
+
+inline Registry registry;
+
+inline void add(Counter counter, std::uint64_t n) {
+    registry.counters[static_cast<std::size_t>(counter)].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline std::uint64_t value(Counter counter) {
+    return registry.counters[static_cast<std::size_t>(counter)].value.load(std::memory_order_relaxed);
+}
+
+// Zero every total (tests, or between runs of a long-lived process)
+void reset();
+
+// Called by the allocation hook
+void recordAllocation(std::size_t bytes);
+
+class ScopedPhase {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedPhase(Phase phase);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    // Innermost phase of the calling thread, or nullptr
+    static const ScopedPhase* current();
+    Phase phase() const { return _phase; }
+
+private:
+    Phase _phase;
+    ScopedPhase* _outer;
+    Clock::time_point _resumed;
+    std::uint64_t _elapsedNs;
+};
+
+#endif
+
+} // namespace stats
+
+#if NANOFORGE_STATS
+#define NF_STATS_CONCAT_INNER(a, b) a##b
+#define NF_STATS_CONCAT(a, b) NF_STATS_CONCAT_INNER(a, b)
+#define NF_STATS_PHASE(phase) \
+    ::stats::ScopedPhase NF_STATS_CONCAT(nfStatsPhase, __LINE__)(::stats::Phase::phase)
+#define NF_STATS_ADD(counter, n) ::stats::add(::stats::Counter::counter, static_cast<std::uint64_t>(n))
+#else
+#define NF_STATS_PHASE(phase) static_cast<void>(0)
+#define NF_STATS_ADD(counter, n) static_cast<void>(0)
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Label symbol table.
+//
+// Names are interned into dense ids (in order of first appearance) through
+// an open-addressing hash table with linear probing, kept at most half full.
+// Name bytes live in one shared buffer; per-symbol data (hash, address,
+// defined flag) lives in parallel arrays indexed by id, so lookups and
+// updates are O(1) and allocate only when a table grows.
+class SymbolTable {
+public:
+    using SymbolId = std::uint32_t;
+    static constexpr SymbolId npos = UINT32_MAX;
+
+    explicit SymbolTable(std::size_t expectedSymbols = 0);
+
+    // Id of 'name', adding it (undefined) on first use
+    SymbolId intern(std::string_view name);
+
+    // Id of 'name', or npos
+    SymbolId find(std::string_view name) const;
+
+    std::size_t size() const { return _hashes.size(); }
+    std::string_view name(SymbolId id) const;
+
+    bool isDefined(SymbolId id) const { return _defined[id] != 0; }
+    std::uint32_t address(SymbolId id) const { return _addresses[id]; }
+
+    // Bind a symbol to an address; false if it already had one
+    bool define(SymbolId id, std::uint32_t address);
+
+    // Forget all symbols, keeping the allocated capacity
+    void clear();
+
+private:
+    static std::uint32_t hashName(std::string_view name);
+    std::size_t probe(std::string_view name, std::uint32_t hash) const;
+    void grow();
+
+    std::vector<SymbolId> _slots;           // npos = empty; size is a power of two
+    std::vector<std::uint32_t> _hashes;
+    std::vector<std::uint32_t> _nameOffsets;
+    std::vector<std::uint32_t> _nameLengths;
+    std::vector<std::uint32_t> _addresses;
+    std::vector<std::uint8_t> _defined;
+    std::string _names;
+};
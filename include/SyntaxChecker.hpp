@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AST.h"
+#include "Diagnostics.hpp"
+#include "FlatTree.hpp"
+#include "Token.hpp"
+
+class Lexer;
+class ThreadPool;
+
+// SyntaxChecker class
+class SyntaxChecker {
+private:
+    const std::unordered_map<std::string, std::vector<Token>>& paramMap;
+
+    // Pattern per built-in mnemonic id (nullptr if paramMap lacks it)
+    std::vector<const std::vector<Token>*> builtinPatterns;
+
+public:
+    // Constructor with paramMap
+    SyntaxChecker(const std::unordered_map<std::string, std::vector<Token>>& paramMap);
+
+    bool checkInstruction(const std::string& instr);
+
+    // Every check reports all problems it finds to 'diagnostics' (stopping
+    // early only if its cap is reached) and returns false if it reported
+    // any. The overloads without a Diagnostics write everything to
+    // std::cerr once, at the end.
+
+    // Check if the tree is syntactically correct
+    bool checkSyntax(const AbstractTree<std::string>& tree, Diagnostics& diagnostics) const;
+    bool checkSyntax(const AbstractTree<std::string>& tree) const;
+
+    // Same, with the root's children (independent subtrees) checked as
+    // tasks on 'pool'. Each task fills its own Diagnostics; they are merged
+    // in child order, so the result is exactly what the sequential check
+    // reports. Trees with few top-level subtrees are checked sequentially.
+    bool checkSyntax(const AbstractTree<std::string>& tree, Diagnostics& diagnostics, ThreadPool& pool) const;
+
+    // Check a flat tree in one linear pass over its node arrays. Validity
+    // and expected arity are looked up once per distinct value rather than
+    // once per node.
+    bool checkSyntax(const FlatTree<std::string>& tree, Diagnostics& diagnostics) const;
+    bool checkSyntax(const FlatTree<std::string>& tree) const;
+
+    // Check line-oriented assembly straight from the token stream, one
+    // "[label:] [instruction operands...]" line at a time, without building
+    // a tree. Each instruction's operand count and kinds are checked against
+    // its paramMap pattern; a word in an immediate slot is accepted as a
+    // label reference. A line with an error is reported once and checking
+    // goes on with the next line.
+    bool checkSyntax(Lexer& lexer, Diagnostics& diagnostics) const;
+    bool checkSyntax(Lexer& lexer) const;
+
+private:
+    // Pattern of an instruction token, or nullptr if it is unknown
+    const std::vector<Token>* findPattern(const Lexer& lexer, const Token& instruction) const;
+
+    // Validate one node's value and child count, without its subtree
+    void checkValue(const AbstractTreeNode<std::string>* node, Diagnostics& diagnostics) const;
+
+    // Validate a subtree, node by node in preorder, without recursing
+    void checkNode(const AbstractTreeNode<std::string>* node, Diagnostics& diagnostics) const;
+
+    // Helper function to check Node validity
+    bool isValidNode(const std::string& value) const;
+
+    // Check number of children nodes
+    bool checkChildren(const std::string& value, std::span<const std::unique_ptr<AbstractTreeNode<std::string>>> children,
+                       Diagnostics& diagnostics) const;
+};
@@ -1,16 +1,27 @@
 #pragma once
 
 #include "AST.h"
+#include "Arena.hpp"
+#include "ArenaTreeNode.hpp"
+#include "TreeTraversal.hpp"
 #include <memory>
-#include <queue>
+#include <vector>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
 
 template <typename T>
 class SyntaxTree : public AbstractTree<T> {
 public:
     // Constructors
-    SyntaxTree() : _root(nullptr) {}
-    explicit SyntaxTree(AbstractTreeNode<T>* root) : _root(root) {}
+    SyntaxTree() : _root(nullptr), _arena(nullptr) {}
+    explicit SyntaxTree(AbstractTreeNode<T>* root) : _root(root), _arena(nullptr) {}
+    // Tree whose nodes are ArenaTreeNodes allocated from 'arena'; clear()
+    // resets the arena, so it must not be shared with other live trees.
+    // setRoot() and ArenaTreeNode::addChild() reject heap nodes, so every
+    // node of the tree lives in the arena.
+    explicit SyntaxTree(Arena& arena) : _root(nullptr), _arena(&arena) {}
 
     // Implementations of AbstractTree<T> pure virtual methods
     AbstractTreeNode<T>* getRoot() const override {
@@ -18,101 +29,89 @@ public:
     }
 
     void setRoot(AbstractTreeNode<T>* root) override {
+        if (_arena && root && typeid(*root) != typeid(ArenaTreeNode<T>)) {
+            throw std::invalid_argument("SyntaxTree: the root of an arena tree must be an arena node");
+        }
         _root = root;
     }
 
     // Preorder traversal (default for 'traverse')
     void traverse(std::ostream& os = std::cout) const override {
-        preorderTraversal(_root, os);
-        os << std::endl;
+        traverse(os, TraversalOrder::PreOrder);
     }
 
-    // Recursively delete all nodes
-    void clear() override {
-        clearNode(_root);
-        _root = nullptr;
+    // Print the node values in the given order
+    void traverse(std::ostream& os, TraversalOrder order) const {
+        visit(order, [&os](const AbstractTreeNode<T>& node, std::size_t) {
+            os << node.getValue() << " ";
+        });
+        os << std::endl;
     }
 
-private:
     // ------------------------
-    // Pre-Order Traversal
+    // Visitor traversals
     // ------------------------
-    void preorderTraversal(AbstractTreeNode<T>* node, std::ostream& os) const {
-        if (!node) return;
-        // Visit the current node
-        os << node->getValue() << " ";
-        // Recursively traverse children
-        for (auto& child : node->getChildren()) {
-            preorderTraversal(child.get(), os);
-        }
+    // visitor(const AbstractTreeNode<T>& node, size_t depth); return false to
+    // stop early. Iterative, see TreeTraversal.hpp.
+    template <typename Visitor>
+    bool visitPreorder(Visitor&& visitor) const {
+        return ::visitPreorder(static_cast<const AbstractTreeNode<T>*>(_root), visitor);
     }
 
-    // ------------------------
-    // In-Order Traversal
-    // ------------------------
-    void inorderTraversal(AbstractTreeNode<T>* node, std::ostream& os) const {
-        if (!node) return;
-        const auto& children = node->getChildren();
-
-        // Process the first child as "left subtree"
-        if (!children.empty()) {
-            inorderTraversal(children[0].get(), os);
-        }
-
-        // Visit the current node
-        os << node->getValue() << " ";
+    template <typename Visitor>
+    bool visitInorder(Visitor&& visitor) const {
+        return ::visitInorder(static_cast<const AbstractTreeNode<T>*>(_root), visitor);
+    }
 
-        // Process the rest of the children as "right subtree"
-        for (size_t i = 1; i < children.size(); ++i) {
-            inorderTraversal(children[i].get(), os);
-        }
+    template <typename Visitor>
+    bool visitPostorder(Visitor&& visitor) const {
+        return ::visitPostorder(static_cast<const AbstractTreeNode<T>*>(_root), visitor);
     }
 
-    // ------------------------
-    // Post-Order Traversal
-    // ------------------------
-    void postorderTraversal(AbstractTreeNode<T>* node, std::ostream& os) const {
-        if (!node) return;
-        // Recursively traverse children first
-        for (auto& child : node->getChildren()) {
-            postorderTraversal(child.get(), os);
-        }
-        // Visit the current node
-        os << node->getValue() << " ";
+    template <typename Visitor>
+    bool visitLevelOrder(Visitor&& visitor) const {
+        return ::visitLevelOrder(static_cast<const AbstractTreeNode<T>*>(_root), visitor);
     }
 
-    // ------------------------
-    // Level-Order Traversal
-    // ------------------------
-    void levelOrderTraversal(AbstractTreeNode<T>* node, std::ostream& os) const {
-        if (!node) return;
-        std::queue<AbstractTreeNode<T>*> bfsQueue;
-        bfsQueue.push(node);
+    template <typename Visitor>
+    bool visit(TraversalOrder order, Visitor&& visitor) const {
+        return visitTree(static_cast<const AbstractTreeNode<T>*>(_root), order, visitor);
+    }
 
-        while (!bfsQueue.empty()) {
-            auto* current = bfsQueue.front();
-            bfsQueue.pop();
-            // Visit the current node
-            os << current->getValue() << " ";
-            for (auto& child : current->getChildren()) {
-                bfsQueue.push(child.get());
+    // Delete all nodes.
+    // Arena trees get their memory back in one reset(). The nodes are still
+    // visited to run destructors when T needs them (std::string does), so
+    // clear() is O(1) only for trivially destructible T such as int.
+    void clear() override {
+        if (_arena) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                clearNode(_root);
             }
+            _root = nullptr;
+            _arena->reset();
+            return;
         }
+        clearNode(_root);
+        _root = nullptr;
     }
 
+private:
     // ------------------------
     // Utility to free all nodes in a subtree
     // ------------------------
     void clearNode(AbstractTreeNode<T>* node) {
         if (!node) return;
-
-        // Recursively clear children first
-        for (auto& child : node->getChildren()) {
-            clearNode(child.get());
+        // Detach each node's children before deleting it, so that no
+        // destructor has to free a subtree recursively
+        std::vector<std::unique_ptr<AbstractTreeNode<T>>> pending;
+        pending.emplace_back(node);
+        while (!pending.empty()) {
+            std::unique_ptr<AbstractTreeNode<T>> current = std::move(pending.back());
+            pending.pop_back();
+            current->releaseChildren(pending);
         }
-        // Then delete this node
-        delete node;
     }
 
     AbstractTreeNode<T>* _root;
+    Arena* _arena;  // Set for arena-backed trees
 };
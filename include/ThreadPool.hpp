@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size, work-stealing pool of worker threads.
+//
+// Each worker owns a task deque. Tasks submitted from a worker go to its own
+// deque and are taken back newest first; tasks submitted from outside are
+// spread round-robin. A worker whose deque is empty steals the oldest task
+// of another worker before going to sleep.
+//
+// parallelFor() is the main entry point: the calling thread works on the
+// loop alongside the workers, so it is safe to call from inside a pool task
+// and never waits on an idle queue.
+class ThreadPool {
+public:
+    // 0 threads means std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(_workers.size()); }
+
+    // Index of the calling thread among this pool's workers, or size() for
+    // any other thread (such as the one calling parallelFor()). Lets loop
+    // bodies keep per-thread scratch in a vector of size() + 1 slots.
+    std::size_t workerIndex() const;
+
+    // Queue a fire-and-forget task
+    void submit(std::function<void()> task);
+
+    // Run body(begin, end) over consecutive, equal ranges covering
+    // [0, count), split into no more ranges than 'minRange' allows. Ranges
+    // are claimed dynamically, so uneven work balances out.
+    void parallelForRanges(std::size_t count, std::size_t minRange,
+                           const std::function<void(std::size_t, std::size_t)>& body);
+
+    // Run body(i) for every i in [0, count); returns once all calls finished.
+    // The first exception thrown by 'body' is rethrown here.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    // Process-wide pool sized to the machine
+    static ThreadPool& shared();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(std::size_t index);
+    bool popLocal(std::size_t index, std::function<void()>& task);
+    bool steal(std::size_t thief, std::function<void()>& task);
+
+    std::vector<std::thread> _workers;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::atomic<std::size_t> _pending;      // Queued tasks not yet taken
+    std::atomic<std::size_t> _nextQueue;    // Round-robin target for outside submits
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stopping;
+};
@@ -1,11 +1,13 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 struct Punctuation {
     std::string type;
 };
 
-enum class TokenType {
+enum class TokenType : std::uint8_t {
     INSTRUCTION,
     REGISTER,
     IMMEDIATE,
@@ -16,25 +18,54 @@ enum class TokenType {
     ERROR
 };
 
+// Compact token: the lexeme is not copied, only its position in the source
+// buffer is kept. Use lexeme()/column() (or the Lexer helpers of the same
+// name) to materialize text and columns when they are actually needed.
 struct Token {
-    TokenType type;
-    std::string lexeme;
-    int line;
-    int column;
+    TokenType     type;
+    std::uint16_t length;   // Lexeme length in bytes
+    std::uint32_t offset;   // Byte offset of the lexeme in the source buffer
+    std::int32_t  line;
+    std::int32_t  value;    // Register number, immediate value (low 32 bits)
+                            // or punctuation character; 0 otherwise
 
-    Token(TokenType t, std::string l, int ln, int col)
-        : type(t), lexeme(std::move(l)), line(ln), column(col) {}
+    Token(TokenType t, std::uint32_t off, std::uint16_t len, std::int32_t ln, std::int32_t val = 0)
+        : type(t), length(len), offset(off), line(ln), value(val) {}
 
+    // Pattern token without a source position (instruction specs)
+    explicit Token(TokenType t, std::int32_t val = 0)
+        : type(t), length(0), offset(0), line(0), value(val) {}
+
+    // Same token: same kind at the same place in the source
     bool operator==(const Token& other) const {
-        return this->type == other.type && this->lexeme == other.lexeme;
+        return this->type == other.type && this->offset == other.offset
+            && this->length == other.length && this->line == other.line
+            && this->value == other.value;
     }
 
     bool compareTokenType(const Token& other) const {
-        if (this->type == TokenType::PUNCTUATION 
+        if (this->type == TokenType::PUNCTUATION
             || other.type == TokenType::PUNCTUATION) {
                 return (this->type == TokenType::PUNCTUATION && other.type == TokenType::PUNCTUATION)
-                    && (this->lexeme == other.lexeme);
+                    && (this->value == other.value);
         }
-        else return this->type == TokenType::PUNCTUATION && other.type == TokenType::PUNCTUATION;
+        else return this->type == other.type;
+    }
+
+    // Text of the token inside 'source' (the buffer it was lexed from)
+    std::string_view lexeme(std::string_view source) const {
+        if (type == TokenType::EoL) return "\n";
+        if (type == TokenType::EoF) return "EOF";
+        return source.substr(offset, length);
+    }
+
+    // 1-based column, recovered by looking back to the start of the line
+    int column(std::string_view source) const {
+        if (type == TokenType::EoF || offset == 0) return 1;
+        size_t newline = source.rfind('\n', offset - 1);
+        size_t lineStart = (newline == std::string_view::npos) ? 0 : newline + 1;
+        return static_cast<int>(offset - lineStart) + 1;
     }
 };
+
+static_assert(sizeof(Token) == 16, "Token should stay a compact 16-byte record");
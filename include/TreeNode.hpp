@@ -13,7 +13,7 @@ public:
     explicit TreeNode(const T& value) : _value(value) {}
 
     // Implementations of AbstractTreeNode<T> pure virtual methods
-    T getValue() const override {
+    const T& getValue() const override {
         return _value;
     }
 
@@ -25,7 +25,7 @@ public:
         _children.emplace_back(std::move(child));
     }
 
-    const std::vector<std::unique_ptr<AbstractTreeNode<T>>>& getChildren() const override {
+    std::span<const std::unique_ptr<AbstractTreeNode<T>>> getChildren() const override {
         return _children;
     }
 
@@ -44,6 +44,13 @@ public:
         return false;
     }
 
+    void releaseChildren(std::vector<std::unique_ptr<AbstractTreeNode<T>>>& out) override {
+        for (auto& child : _children) {
+            out.emplace_back(std::move(child));
+        }
+        _children.clear();
+    }
+
 private:
     T _value;
     // Store children as unique_ptr to manage ownership
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "AST.h"
+#include <cstddef>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+// Iterative tree walks over AbstractTreeNode. None of them recurse, so
+// tree depth is bounded only by memory.
+//
+// A visitor is called as visit(const AbstractTreeNode<T>& node, size_t depth)
+// (the root has depth 0). It may return bool: false stops the walk early.
+// Visitors returning void always run to completion. Each walk returns false
+// if it was stopped, true otherwise. Null children are skipped.
+
+enum class TraversalOrder {
+    PreOrder,
+    InOrder,    // First child as the "left subtree", then the node, then the rest
+    PostOrder,
+    LevelOrder
+};
+
+namespace traversal_detail {
+
+template <typename T, typename Visitor>
+bool call(Visitor& visit, const AbstractTreeNode<T>& node, std::size_t depth) {
+    if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, const AbstractTreeNode<T>&, std::size_t>>) {
+        visit(node, depth);
+        return true;
+    } else {
+        return static_cast<bool>(visit(node, depth));
+    }
+}
+
+template <typename T>
+struct Frame {
+    const AbstractTreeNode<T>* node;
+    std::size_t depth;
+    std::size_t next;       // Next child to descend into
+    bool visited;
+};
+
+} // namespace traversal_detail
+
+template <typename T, typename Visitor>
+bool visitPreorder(const AbstractTreeNode<T>* root, Visitor&& visit) {
+    if (!root) return true;
+    std::vector<std::pair<const AbstractTreeNode<T>*, std::size_t>> stack;
+    stack.emplace_back(root, 0);
+
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        if (!traversal_detail::call<T>(visit, *node, depth)) {
+            return false;
+        }
+        // Push children in reverse so the first child is visited next
+        auto children = node->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            if (*it) {
+                stack.emplace_back(it->get(), depth + 1);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Visitor>
+bool visitPostorder(const AbstractTreeNode<T>* root, Visitor&& visit) {
+    if (!root) return true;
+    std::vector<traversal_detail::Frame<T>> stack;
+    stack.push_back({root, 0, 0, false});
+
+    while (!stack.empty()) {
+        auto& frame = stack.back();
+        auto children = frame.node->getChildren();
+        if (frame.next < children.size()) {
+            const AbstractTreeNode<T>* child = children[frame.next++].get();
+            if (child) {
+                std::size_t depth = frame.depth + 1;
+                stack.push_back({child, depth, 0, false});
+            }
+            continue;
+        }
+        // All children done: visit the node itself
+        if (!traversal_detail::call<T>(visit, *frame.node, frame.depth)) {
+            return false;
+        }
+        stack.pop_back();
+    }
+    return true;
+}
+
+template <typename T, typename Visitor>
+bool visitInorder(const AbstractTreeNode<T>* root, Visitor&& visit) {
+    if (!root) return true;
+    std::vector<traversal_detail::Frame<T>> stack;
+    stack.push_back({root, 0, 0, false});
+
+    while (!stack.empty()) {
+        auto& frame = stack.back();
+        auto children = frame.node->getChildren();
+
+        // Left subtree first
+        if (frame.next == 0 && !children.empty()) {
+            frame.next = 1;
+            const AbstractTreeNode<T>* left = children[0].get();
+            if (left) {
+                std::size_t depth = frame.depth + 1;
+                stack.push_back({left, depth, 0, false});
+            }
+            continue;
+        }
+        // Then the node
+        if (!frame.visited) {
+            frame.visited = true;
+            if (frame.next == 0) frame.next = 1;
+            if (!traversal_detail::call<T>(visit, *frame.node, frame.depth)) {
+                return false;
+            }
+        }
+        // Then the remaining children, in order
+        if (frame.next < children.size()) {
+            const AbstractTreeNode<T>* child = children[frame.next++].get();
+            if (child) {
+                std::size_t depth = frame.depth + 1;
+                stack.push_back({child, depth, 0, false});
+            }
+            continue;
+        }
+        stack.pop_back();
+    }
+    return true;
+}
+
+template <typename T, typename Visitor>
+bool visitLevelOrder(const AbstractTreeNode<T>* root, Visitor&& visit) {
+    if (!root) return true;
+    std::deque<std::pair<const AbstractTreeNode<T>*, std::size_t>> bfsQueue;
+    bfsQueue.emplace_back(root, 0);
+
+    while (!bfsQueue.empty()) {
+        auto [node, depth] = bfsQueue.front();
+        bfsQueue.pop_front();
+        if (!traversal_detail::call<T>(visit, *node, depth)) {
+            return false;
+        }
+        for (auto& child : node->getChildren()) {
+            if (child) {
+                bfsQueue.emplace_back(child.get(), depth + 1);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Visitor>
+bool visitTree(const AbstractTreeNode<T>* root, TraversalOrder order, Visitor&& visit) {
+    switch (order) {
+        case TraversalOrder::PreOrder:   return visitPreorder(root, visit);
+        case TraversalOrder::InOrder:    return visitInorder(root, visit);
+        case TraversalOrder::PostOrder:  return visitPostorder(root, visit);
+        case TraversalOrder::LevelOrder: return visitLevelOrder(root, visit);
+    }
+    return true;
+}
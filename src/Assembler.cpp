@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+#include "../include/Assembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/RV32I.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ThreadPool.hpp"
+
+namespace {
+
+const char* operandKind(const Token& pattern, bool takesLabels) {
+    switch (pattern.type) {
+        case TokenType::REGISTER:    return "a register";
+        case TokenType::IMMEDIATE:   return takesLabels ? "an immediate or label" : "an immediate";
+        case TokenType::PUNCTUATION: return "punctuation";
+        case TokenType::LABEL:       return "a label";
+        default:                     return "an operand";
+    }
+}
+
+// Words that were meant as labels but are not spelled like one
+bool misspelledLabel(std::string_view word) {
+    return word.find('_') != std::string_view::npos;
+}
+
+const char* const kLabelRule = "a label name is a letter followed by letters and digits";
+
+} // namespace
+
+Assembler::Assembler(const Encoder& encoder)
+    : _encoder(encoder),
+      _diagnostics(&std::cerr),
+      _errorCount(0)
+{
+    // Built-in instruction tokens carry their mnemonic id; map it once
+    _fromMnemonic.resize(rv32i::mnemonics.size());
+    for (std::size_t i = 0; i < rv32i::mnemonics.size(); ++i) {
+        _fromMnemonic[i] = encoder.find(rv32i::mnemonics[i]);
+    }
+}
+
+bool Assembler::assemble(Lexer& lexer) {
+    NF_STATS_PHASE(Assemble);
+    std::string_view source = lexer.source();
+    std::size_t errorsBefore = _errorCount;
+    [[maybe_unused]] std::size_t instructionsBefore = _instructions.size();
+    Token instruction(TokenType::ERROR);
+    bool haveInstruction = false;
+    bool skipLine = false;
+    _lineOperands.clear();
+
+    while (lexer.hasMoreTokens()) {
+        Token token = lexer.getNextToken();
+
+        if (token.type == TokenType::EoL || token.type == TokenType::EoF) {
+            if (haveInstruction && !skipLine) {
+                assembleInstruction(source, instruction, _lineOperands);
+            }
+            haveInstruction = false;
+            skipLine = false;
+            _lineOperands.clear();
+            if (token.type == TokenType::EoF) {
+                break;
+            }
+            continue;
+        }
+        if (skipLine) {
+            continue;
+        }
+
+        if (haveInstruction) {
+            _lineOperands.push_back(token);
+        } else if (token.type == TokenType::LABEL) {
+            defineLabel(source, token);
+        } else if (token.type == TokenType::INSTRUCTION) {
+            instruction = token;
+            haveInstruction = true;
+        } else {
+            reportUnexpected(source, token);
+            skipLine = true;
+        }
+    }
+
+    // Whatever is still pending refers to labels that were never defined.
+    // Operands are stored in source order, so sorting by operand index
+    // reports them by line, as IncrementalAssembler does.
+    std::vector<std::uint32_t> undefined;
+    for (SymbolTable::SymbolId id = 0; id < _pendingHead.size(); ++id) {
+        for (std::uint32_t f = _pendingHead[id]; f != npos; f = _fixups[f].next) {
+            undefined.push_back(_fixups[f].operand);
+        }
+        _pendingHead[id] = npos;
+    }
+    std::sort(undefined.begin(), undefined.end());
+    for (std::uint32_t operand : undefined) {
+        const Token& reference = _operands[operand];
+        error(source, reference, "Undefined label '" + std::string(reference.lexeme(source)) + "'");
+    }
+    NF_STATS_ADD(Instructions, _instructions.size() - instructionsBefore);
+    NF_STATS_ADD(Errors, _errorCount - errorsBefore);
+    return _errorCount == errorsBefore;
+}
+
+std::size_t Assembler::lookupInstruction(std::string_view source, const Token& token) const {
+    std::string_view word = token.lexeme(source);
+    // Custom instruction sets leave value at 0, so confirm the spelling
+    if (token.value >= 0 && static_cast<std::size_t>(token.value) < _fromMnemonic.size()
+        && rv32i::mnemonics[token.value] == word) {
+        return _fromMnemonic[token.value];
+    }
+    return _encoder.find(word);
+}
+
+void Assembler::reportUnexpected(std::string_view source, const Token& token) {
+    std::string_view word = token.lexeme(source);
+    if (token.type == TokenType::ERROR && word.ends_with(':')) {
+        error(source, token, "Invalid label '" + std::string(word) + "', " + kLabelRule);
+    } else {
+        error(source, token, "Expected an instruction or label, found '" + std::string(word) + "'");
+    }
+}
+
+bool Assembler::checkInstruction(std::string_view source, const Token& instruction,
+                                 std::span<const Token> operands,
+                                 std::size_t& id, std::uint32_t& labelMask) {
+    std::string_view name = instruction.lexeme(source);
+    id = lookupInstruction(source, instruction);
+    if (id == Encoder::npos) {
+        error(source, instruction, "No encoding for instruction '" + std::string(name) + "'");
+        return false;
+    }
+
+    // One pass over the operands through the pattern automaton; words it
+    // took for label references must still be spelled like identifiers
+    PatternAutomaton::Match match = _encoder.automaton().match(id, operands);
+    for (std::uint32_t mask = match.labelMask; match.ok && mask != 0; mask &= mask - 1) {
+        match.ok = isLabelName(operands[std::countr_zero(mask)].lexeme(source));
+    }
+    if (!match.ok) {
+        reportMismatch(source, instruction, id, operands);
+        return false;
+    }
+    labelMask = match.labelMask;
+    return true;
+}
+
+void Assembler::assembleInstruction(std::string_view source, const Token& instruction,
+                                    const std::vector<Token>& lineOperands) {
+    std::size_t id;
+    std::uint32_t labelMask;
+    if (!checkInstruction(source, instruction, lineOperands, id, labelMask)) {
+        return;
+    }
+
+    auto first = static_cast<std::uint32_t>(_operands.size());
+    _instructions.push_back(InstructionRecord{static_cast<std::uint32_t>(id), first});
+    _operands.insert(_operands.end(), lineOperands.begin(), lineOperands.end());
+
+    for (std::uint32_t i = 0; i < lineOperands.size(); ++i) {
+        Token& operand = _operands[first + i];
+        if (operand.type == TokenType::ERROR) {
+            resolveReference(source, operand, first + i);
+        } else if (operand.type == TokenType::IMMEDIATE) {
+            checkImmediate(source, operand, id);
+        }
+    }
+}
+
+// Slow path, only for lines that failed to match: say what is wrong
+void Assembler::reportMismatch(std::string_view source, const Token& instruction, std::size_t id,
+                               std::span<const Token> lineOperands) {
+    std::string_view name = instruction.lexeme(source);
+    auto pattern = _encoder.pattern(id);
+    if (lineOperands.size() != pattern.size()) {
+        error(source, instruction, "Instruction '" + std::string(name) + "' expects "
+              + std::to_string(pattern.size()) + " operands, but has "
+              + std::to_string(lineOperands.size()));
+        return;
+    }
+    bool takesLabels = isPcRelative(_encoder.encoding(id));
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        const Token& operand = lineOperands[i];
+        bool labelReference = pattern[i].type == TokenType::IMMEDIATE
+                           && operand.type == TokenType::ERROR
+                           && isLabelName(operand.lexeme(source));
+        if (labelReference && !takesLabels) {
+            error(source, operand, "Operand " + std::to_string(i + 1) + " of '" + std::string(name)
+                  + "' names label '" + std::string(operand.lexeme(source))
+                  + "', label not allowed here (only branches and jumps take labels)");
+            return;
+        }
+        if (!labelReference && takesLabels && pattern[i].type == TokenType::IMMEDIATE
+            && operand.type == TokenType::ERROR && misspelledLabel(operand.lexeme(source))) {
+            error(source, operand, "Operand " + std::to_string(i + 1) + " of '" + std::string(name)
+                  + "' is not a valid label name, found '" + std::string(operand.lexeme(source))
+                  + "' (" + kLabelRule + ")");
+            return;
+        }
+        if (!labelReference && !pattern[i].compareTokenType(operand)) {
+            error(source, operand, "Operand " + std::to_string(i + 1) + " of '" + std::string(name)
+                  + "' should be " + operandKind(pattern[i], takesLabels) + ", found '"
+                  + std::string(operand.lexeme(source)) + "'");
+            return;
+        }
+    }
+    error(source, instruction, "Operands of '" + std::string(name) + "' do not match its pattern");
+}
+
+void Assembler::defineLabel(std::string_view source, const Token& label) {
+    std::string_view name = label.lexeme(source);
+    name.remove_suffix(1);      // Trailing ':'
+
+    SymbolTable::SymbolId id = _symbols.intern(name);
+    if (id >= _pendingHead.size()) {
+        _pendingHead.resize(id + 1, npos);
+    }
+
+    auto address = static_cast<std::uint32_t>(_instructions.size() * 4);
+    if (!_symbols.define(id, address)) {
+        error(source, label, "Label '" + std::string(name) + "' is already defined");
+        return;
+    }
+
+    // Patch every forward reference seen so far
+    for (std::uint32_t f = _pendingHead[id]; f != npos; f = _fixups[f].next) {
+        const Fixup& fixup = _fixups[f];
+        Token& operand = _operands[fixup.operand];
+        operand.type = TokenType::IMMEDIATE;
+        operand.value = static_cast<std::int32_t>(address) - static_cast<std::int32_t>(fixup.instruction * 4);
+        checkImmediate(source, operand, _instructions[fixup.instruction].id);
+    }
+    _pendingHead[id] = npos;
+}
+
+bool Assembler::resolveReference(std::string_view source, Token& operand, std::uint32_t operandIndex) {
+    SymbolTable::SymbolId id = _symbols.intern(operand.lexeme(source));
+    if (id >= _pendingHead.size()) {
+        _pendingHead.resize(id + 1, npos);
+    }
+
+    auto instruction = static_cast<std::uint32_t>(_instructions.size() - 1);
+    if (_symbols.isDefined(id)) {
+        operand.type = TokenType::IMMEDIATE;
+        operand.value = static_cast<std::int32_t>(_symbols.address(id))
+                      - static_cast<std::int32_t>(instruction * 4);
+        checkImmediate(source, operand, _instructions[instruction].id);
+        return true;
+    }
+
+    _fixups.push_back(Fixup{operandIndex, instruction, _pendingHead[id]});
+    _pendingHead[id] = static_cast<std::uint32_t>(_fixups.size() - 1);
+    return false;
+}
+
+bool Assembler::checkImmediate(std::string_view source, const Token& operand, std::size_t id) {
+    if (!immediateFits(_encoder.encoding(id), operand.value)) {
+        error(source, operand, "Immediate " + std::to_string(operand.value)
+              + " does not fit the instruction's encoding");
+        return false;
+    }
+    return true;
+}
+
+void Assembler::error(std::string_view source, const Token& token, const std::string& message) {
+    *_diagnostics << "Assembly Error (line " << token.line << ", column " << token.column(source)
+              << "): " << message << "\n";
+    ++_errorCount;
+}
+
+void Assembler::encode(std::vector<std::uint32_t>& out, ThreadPool& pool) const {
+    NF_STATS_PHASE(Encode);
+    out.resize(_instructions.size());
+    _encoder.encodeAll(_instructions, _operands, out, pool);
+}
+
+void Assembler::encode(std::vector<std::uint32_t>& out) const {
+    encode(out, ThreadPool::shared());
+}
+
+void Assembler::reset() {
+    _instructions.clear();
+    _operands.clear();
+    _symbols.clear();
+    _pendingHead.clear();
+    _fixups.clear();
+    _lineOperands.clear();
+    _errorCount = 0;
+}
@@ -0,0 +1,94 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "../include/BatchAssembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ThreadPool.hpp"
+
+BatchAssembler::BatchAssembler(const Encoder& encoder, ThreadPool& pool)
+    : _encoder(encoder),
+      _pool(pool),
+      _customVocabulary(!encoder.builtinMnemonicsOnly())
+{
+    if (_customVocabulary) {
+        for (std::size_t id = 0; id < encoder.size(); ++id) {
+            _instructions.emplace(encoder.name(id));
+        }
+        _punctuation = {"(", ")", ":"};
+    }
+    _contexts.reserve(pool.size() + 1);
+    for (unsigned i = 0; i <= pool.size(); ++i) {
+        _contexts.push_back(std::make_unique<Context>(encoder));
+    }
+}
+
+BatchAssembler::~BatchAssembler() = default;
+
+std::vector<BatchResult> BatchAssembler::assemble(std::span<const std::string> inputs) {
+    std::vector<BatchResult> results(inputs.size());
+    _pool.parallelFor(inputs.size(), [&](std::size_t i) {
+        assembleFile(inputs[i], results[i]);
+    });
+    return results;
+}
+
+void BatchAssembler::assembleFile(const std::string& input, BatchResult& result) {
+    Context& context = *_contexts[_pool.workerIndex()];
+    context.tokens.clear();
+    context.assembler.reset();
+    context.diagnostics.str(std::string());
+
+    result.input = input;
+    result.words.clear();
+    result.symbols.clear();
+    NF_STATS_ADD(Files, 1);
+    try {
+        MappedFile source(input);
+        if (_customVocabulary) {
+            Lexer lexer(source, context.tokens, _instructions, _punctuation);
+            assembleTokens(lexer, context, result);
+        } else {
+            Lexer lexer(source, context.tokens);
+            assembleTokens(lexer, context, result);
+        }
+    } catch (const std::exception& e) {
+        context.diagnostics << e.what() << "\n";
+        result.ok = false;
+    }
+    result.diagnostics = context.diagnostics.str();
+}
+
+void BatchAssembler::assembleTokens(Lexer& lexer, Context& context, BatchResult& result) {
+    result.ok = context.assembler.assemble(lexer);
+    if (result.ok) {
+        // Small programs stay on this thread; encodeAll only fans out
+        // for programs large enough to pay for it
+        context.assembler.encode(result.words, _pool);
+        result.symbols = context.assembler.symbols();
+    }
+}
+
+bool BatchAssembler::readManifest(const std::string& manifestPath, std::vector<std::string>& inputs) {
+    std::ifstream manifest(manifestPath);
+    if (!manifest.is_open()) {
+        std::cerr << "Failed to open manifest: " << manifestPath << "\n";
+        return false;
+    }
+
+    std::filesystem::path base = std::filesystem::path(manifestPath).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        auto start = line.find_first_not_of(" \t\r");
+        auto end   = line.find_last_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        std::filesystem::path input(line.substr(start, end - start + 1));
+        inputs.push_back(input.is_absolute() ? input.string() : (base / input).string());
+    }
+    return true;
+}
@@ -0,0 +1,162 @@
+#include "../include/CharScan.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NANOFORGE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ------------------------
+// Scalar fallback
+// ------------------------
+const char* findWordEndScalar(const char* p, const char* end) {
+    while (p < end && charClassOf(*p) == CC_WORD) {
+        ++p;
+    }
+    return p;
+}
+
+const char* findTokenStartScalar(const char* p, const char* end) {
+    while (p < end && charClassOf(*p) == CC_SEPARATOR) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef NANOFORGE_X86_SIMD
+
+// ------------------------
+// SSE2 (baseline on x86-64)
+// ------------------------
+// Bytes >= 0x80 compare as negative, so they never fall in a range.
+inline __m128i inRange16(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+inline __m128i wordMask16(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));     // Fold A-Z onto a-z
+    __m128i alpha = inRange16(lower, 'a', 'z');
+    __m128i digit = inRange16(v, '0', '9');
+    __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+const char* findWordEndSse2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(wordMask16(v))) ^ 0xFFFFu;
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return findWordEndScalar(p, end);
+}
+
+const char* findTokenStartSse2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i stop = _mm_or_si128(wordMask16(v),
+                       _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('(')),
+                       _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(')')),
+                       _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                                    _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))))));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stop));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return findTokenStartScalar(p, end);
+}
+
+// ------------------------
+// AVX2 (selected at runtime)
+// ------------------------
+__attribute__((target("avx2")))
+inline __m256i inRange32(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+__attribute__((target("avx2")))
+inline __m256i wordMask32(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i alpha = inRange32(lower, 'a', 'z');
+    __m256i digit = inRange32(v, '0', '9');
+    __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+}
+
+__attribute__((target("avx2")))
+const char* findWordEndAvx2(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(wordMask32(v)));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findWordEndSse2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* findTokenStartAvx2(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i stop = _mm256_or_si256(wordMask32(v),
+                       _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('(')),
+                       _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(')')),
+                       _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+                                       _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))))));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stop));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findTokenStartSse2(p, end);
+}
+
+#endif // NANOFORGE_X86_SIMD
+
+struct CharScanner {
+    const char* (*wordEnd)(const char*, const char*);
+    const char* (*tokenStart)(const char*, const char*);
+    const char* name;
+};
+
+CharScanner selectCharScanner() {
+#ifdef NANOFORGE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { findWordEndAvx2, findTokenStartAvx2, "avx2" };
+    }
+    return { findWordEndSse2, findTokenStartSse2, "sse2" };
+#else
+    return { findWordEndScalar, findTokenStartScalar, "scalar" };
+#endif
+}
+
+// Function-local so it is ready even for lexing during static initialization
+const CharScanner& charScanner() {
+    static const CharScanner scanner = selectCharScanner();
+    return scanner;
+}
+
+} // namespace
+
+const char* findWordEnd(const char* p, const char* end) {
+    return charScanner().wordEnd(p, end);
+}
+
+const char* findTokenStart(const char* p, const char* end) {
+    return charScanner().tokenStart(p, end);
+}
+
+const char* charScanImplementation() {
+    return charScanner().name;
+}
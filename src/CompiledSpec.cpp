@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/CompiledSpec.hpp"
+#include "../include/Stats.hpp"
+
+static_assert(std::is_trivially_copyable_v<Token>, "Tokens are stored verbatim in the spec image");
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'F', 'S', 'P', 'E', 'C', '\0', '\0'};
+
+struct SourceStamp {
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+};
+
+bool statSource(const std::string& path, SourceStamp& stamp) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<std::uint64_t>(st.st_size);
+    stamp.mtimeNs = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000
+                  + st.st_mtim.tv_nsec;
+    return true;
+}
+
+std::uint64_t fnv1a64(const std::byte* data, std::size_t size) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= static_cast<std::uint8_t>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+constexpr std::size_t align8(std::size_t n) {
+    return (n + 7) & ~static_cast<std::size_t>(7);
+}
+
+// Section offsets of an image with the given counts
+struct Layout {
+    std::size_t instructions, tokens, fields, strings, total;
+
+    Layout(std::size_t instructionCount, std::size_t tokenCount,
+           std::size_t fieldCount, std::size_t stringBytes) {
+        instructions = align8(sizeof(SpecHeader));
+        tokens  = align8(instructions + instructionCount * sizeof(SpecInstruction));
+        fields  = align8(tokens + tokenCount * sizeof(Token));
+        strings = align8(fields + fieldCount * sizeof(SpecField));
+        total   = align8(strings + stringBytes);
+    }
+};
+
+// Write through a temporary file and rename, so that concurrent readers
+// never see a half-written cache
+bool writeFile(const std::string& path, const std::vector<std::byte>& image) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string tmp = path + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(image.data()),
+                  static_cast<std::streamsize>(image.size()));
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+CompiledSpec::CompiledSpec(const std::string& specPath, const std::string& cachePath)
+    : _fromCache(false),
+      _header(nullptr),
+      _instructions(nullptr),
+      _tokens(nullptr),
+      _fields(nullptr),
+      _strings(nullptr)
+{
+    NF_STATS_PHASE(SpecLoad);
+    const std::string cache = cachePath.empty() ? defaultCachePath(specPath) : cachePath;
+
+    SourceStamp stamp;
+    if (!statSource(specPath, stamp)) {
+        throw std::runtime_error("Instruction spec not found: " + specPath);
+    }
+
+    // Fast path: map the existing cache and check it still matches the spec
+    try {
+        if (cache.empty()) {
+            throw std::runtime_error("No cache directory");
+        }
+        MappedFile mapped(cache);
+        const auto* data = reinterpret_cast<const std::byte*>(mapped.data());
+        if (attach(data, mapped.size())
+            && _header->sourceSize == stamp.size
+            && _header->sourceMtimeNs == stamp.mtimeNs) {
+            _mapped = std::move(mapped);
+            _fromCache = true;
+            NF_STATS_ADD(BytesRead, _mapped.size());
+            NF_STATS_ADD(SpecInstructions, size());
+            return;
+        }
+    } catch (const std::runtime_error&) {
+        // No cache yet
+    }
+
+    // Slow path: parse the spec and rewrite the cache
+    if (!compile(specPath, _owned)) {
+        throw std::runtime_error("Failed to parse instruction spec: " + specPath);
+    }
+    if (!cache.empty() && !writeFile(cache, _owned)) {
+        std::cerr << "Warning: could not write spec cache " << cache << "\n";
+    }
+    if (!attach(_owned.data(), _owned.size())) {
+        throw std::runtime_error("Invalid spec image built from: " + specPath);
+    }
+}
+
+std::string CompiledSpec::defaultCachePath(const std::string& specPath) {
+    std::filesystem::path dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        dir = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        dir = std::filesystem::path(home) / ".cache";
+    } else {
+        return "";
+    }
+
+    std::error_code ec;
+    std::string absolute = std::filesystem::absolute(specPath, ec).lexically_normal().string();
+    if (ec) {
+        absolute = specPath;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "spec-%016llx.bin", static_cast<unsigned long long>(
+        fnv1a64(reinterpret_cast<const std::byte*>(absolute.data()), absolute.size())));
+    return (dir / "nanoforge" / name).string();
+}
+
+bool CompiledSpec::compile(const std::string& specPath, std::vector<std::byte>& out) {
+    // Stamp before parsing: if the file changes meanwhile, the next run sees
+    // a newer mtime and rebuilds
+    SourceStamp stamp;
+    if (!statSource(specPath, stamp)) {
+        std::cerr << "Failed to open file: " << specPath << "\n";
+        return false;
+    }
+
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+    if (!parseInstructionFile(specPath, paramMap, binaryMap)) {
+        return false;
+    }
+
+    std::vector<std::string_view> names;
+    names.reserve(paramMap.size());
+    for (const auto& kv : paramMap) {
+        names.push_back(kv.first);
+    }
+    std::sort(names.begin(), names.end());
+
+    std::vector<SpecInstruction> instructions;
+    std::vector<Token> tokens;
+    std::vector<SpecField> fields;
+    std::string strings;
+    instructions.reserve(names.size());
+
+    for (std::string_view name : names) {
+        SpecInstruction entry{};
+        entry.nameOffset = static_cast<std::uint32_t>(strings.size());
+        entry.nameLength = static_cast<std::uint32_t>(name.size());
+        strings.append(name);
+
+        const auto& params = paramMap.find(std::string(name))->second;
+        entry.firstToken = static_cast<std::uint32_t>(tokens.size());
+        entry.tokenCount = static_cast<std::uint32_t>(params.size());
+        tokens.insert(tokens.end(), params.begin(), params.end());
+
+        entry.firstField = static_cast<std::uint32_t>(fields.size());
+        auto bits = binaryMap.find(std::string(name));
+        if (bits != binaryMap.end()) {
+            for (const BitField& bf : bits->second) {
+                SpecField field{};
+                field.bitCount = static_cast<std::uint32_t>(bf.bitCount);
+                field.textOffset = static_cast<std::uint32_t>(strings.size());
+                field.textLength = static_cast<std::uint32_t>(bf.field.size());
+                strings.append(bf.field);
+                fields.push_back(field);
+            }
+        }
+        entry.fieldCount = static_cast<std::uint32_t>(fields.size()) - entry.firstField;
+        instructions.push_back(entry);
+    }
+
+    Layout layout(instructions.size(), tokens.size(), fields.size(), strings.size());
+    out.assign(layout.total, std::byte{0});
+
+    SpecHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.tokenSize = sizeof(Token);
+    header.sourceSize = stamp.size;
+    header.sourceMtimeNs = stamp.mtimeNs;
+    header.instructionCount = static_cast<std::uint32_t>(instructions.size());
+    header.tokenCount = static_cast<std::uint32_t>(tokens.size());
+    header.fieldCount = static_cast<std::uint32_t>(fields.size());
+    header.stringBytes = static_cast<std::uint32_t>(strings.size());
+
+    std::memcpy(out.data() + layout.instructions, instructions.data(),
+                instructions.size() * sizeof(SpecInstruction));
+    std::memcpy(out.data() + layout.tokens, tokens.data(), tokens.size() * sizeof(Token));
+    std::memcpy(out.data() + layout.fields, fields.data(), fields.size() * sizeof(SpecField));
+    std::memcpy(out.data() + layout.strings, strings.data(), strings.size());
+
+    header.checksum = fnv1a64(out.data() + sizeof(SpecHeader), out.size() - sizeof(SpecHeader));
+    std::memcpy(out.data(), &header, sizeof(header));
+    return true;
+}
+
+bool CompiledSpec::attach(const std::byte* data, std::size_t size) {
+    if (!data || size < sizeof(SpecHeader)) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const SpecHeader*>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+        || header->version != kVersion
+        || header->tokenSize != sizeof(Token)) {
+        return false;
+    }
+
+    Layout layout(header->instructionCount, header->tokenCount,
+                  header->fieldCount, header->stringBytes);
+    if (layout.total != size
+        || fnv1a64(data + sizeof(SpecHeader), size - sizeof(SpecHeader)) != header->checksum) {
+        return false;
+    }
+
+    // Every range must stay inside its section, so later lookups need no checks
+    const auto* instructions = reinterpret_cast<const SpecInstruction*>(data + layout.instructions);
+    const auto* fields = reinterpret_cast<const SpecField*>(data + layout.fields);
+    auto inRange = [](std::uint64_t first, std::uint64_t count, std::uint64_t limit) {
+        return first <= limit && count <= limit - first;
+    };
+    for (std::uint32_t i = 0; i < header->instructionCount; ++i) {
+        const SpecInstruction& entry = instructions[i];
+        if (!inRange(entry.nameOffset, entry.nameLength, header->stringBytes)
+            || !inRange(entry.firstToken, entry.tokenCount, header->tokenCount)
+            || !inRange(entry.firstField, entry.fieldCount, header->fieldCount)) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header->fieldCount; ++i) {
+        if (!inRange(fields[i].textOffset, fields[i].textLength, header->stringBytes)) {
+            return false;
+        }
+    }
+
+    _header = header;
+    _instructions = instructions;
+    _tokens = reinterpret_cast<const Token*>(data + layout.tokens);
+    _fields = fields;
+    _strings = reinterpret_cast<const char*>(data + layout.strings);
+    return true;
+}
+
+std::size_t CompiledSpec::find(std::string_view name) const {
+    std::size_t lo = 0, hi = size();
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        int cmp = this->name(mid).compare(name);
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return npos;
+}
+
+std::string_view CompiledSpec::name(std::size_t index) const {
+    const SpecInstruction& entry = _instructions[index];
+    return std::string_view(_strings + entry.nameOffset, entry.nameLength);
+}
+
+std::span<const Token> CompiledSpec::tokens(std::size_t index) const {
+    const SpecInstruction& entry = _instructions[index];
+    return std::span<const Token>(_tokens + entry.firstToken, entry.tokenCount);
+}
+
+std::span<const SpecField> CompiledSpec::fields(std::size_t index) const {
+    const SpecInstruction& entry = _instructions[index];
+    return std::span<const SpecField>(_fields + entry.firstField, entry.fieldCount);
+}
+
+std::string_view CompiledSpec::fieldText(const SpecField& field) const {
+    return std::string_view(_strings + field.textOffset, field.textLength);
+}
+
+void CompiledSpec::toMaps(std::unordered_map<std::string, std::vector<Token>>& paramMap,
+                          std::unordered_map<std::string, std::vector<BitField>>& binaryMap) const {
+    for (std::size_t i = 0; i < size(); ++i) {
+        std::string key(name(i));
+        auto params = tokens(i);
+        paramMap[key].assign(params.begin(), params.end());
+
+        auto& bits = binaryMap[key];
+        bits.clear();
+        for (const SpecField& field : fields(i)) {
+            bits.push_back(BitField{static_cast<int>(field.bitCount), std::string(fieldText(field))});
+        }
+    }
+}
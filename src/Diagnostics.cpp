@@ -0,0 +1,104 @@
+#include <array>
+#include <ostream>
+
+#include "../include/Diagnostics.hpp"
+
+namespace {
+
+struct Template {
+    bool warning;
+    std::string_view text;      // {N} is replaced by argument N
+};
+
+constexpr std::array<Template, static_cast<std::size_t>(DiagnosticCode::Count)> templates = {{
+    {true,  "The tree is empty (no root node)."},
+    {false, "Invalid node value '{0}'."},
+    {false, "Node '{0}' expects {1} parameters, but has {2}."},
+    {false, "Parameter {0} of '{1}' has the wrong kind: '{2}'."},
+    {false, "Expected an instruction or label, found '{0}'."},
+}};
+
+} // namespace
+
+void Diagnostics::addArg(std::string_view text) {
+    _args.push_back(Arg{true, 0, static_cast<std::uint32_t>(_text.size()), static_cast<std::uint32_t>(text.size())});
+    _text.append(text);
+}
+
+bool Diagnostics::append(const Diagnostics& other) {
+    for (const Diagnostic& diagnostic : other._entries) {
+        if (full()) {
+            return false;
+        }
+        Diagnostic copy = diagnostic;
+        copy.firstArg = static_cast<std::uint32_t>(_args.size());
+        for (std::uint8_t i = 0; i < diagnostic.argCount; ++i) {
+            Arg arg = other._args[diagnostic.firstArg + i];
+            if (arg.isText) {
+                arg.offset = static_cast<std::uint32_t>(_text.size());
+                _text.append(other._text, other._args[diagnostic.firstArg + i].offset, arg.length);
+            }
+            _args.push_back(arg);
+        }
+        _entries.push_back(copy);
+    }
+    return !full();
+}
+
+std::string Diagnostics::format(const Diagnostic& diagnostic) const {
+    const Template& entry = templates[static_cast<std::size_t>(diagnostic.code)];
+    std::string out;
+    if (entry.warning) {
+        out = "Warning! ";
+    } else if (diagnostic.line > 0) {
+        out = "Syntax Error (line " + std::to_string(diagnostic.line) + ", column "
+            + std::to_string(diagnostic.column) + "): ";
+    } else {
+        out = "Syntax Error: ";
+    }
+
+    std::string_view text = entry.text;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '{' && i + 2 < text.size() && text[i + 2] == '}') {
+            std::size_t n = static_cast<std::size_t>(text[i + 1] - '0');
+            if (n < diagnostic.argCount) {
+                const Arg& arg = _args[diagnostic.firstArg + n];
+                if (arg.isText) {
+                    out.append(_text, arg.offset, arg.length);
+                } else {
+                    out += std::to_string(arg.number);
+                }
+            }
+            i += 2;
+            continue;
+        }
+        out += text[i];
+    }
+    return out;
+}
+
+std::string Diagnostics::str() const {
+    std::string out;
+    for (const Diagnostic& diagnostic : _entries) {
+        out += format(diagnostic);
+        out += '\n';
+    }
+    if (full()) {
+        out += "Stopped after " + std::to_string(_entries.size()) + " errors.\n";
+    }
+    return out;
+}
+
+void Diagnostics::write(std::ostream& os) const {
+    if (_entries.empty()) {
+        return;
+    }
+    std::string out = str();
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void Diagnostics::clear() {
+    _entries.clear();
+    _args.clear();
+    _text.clear();
+}
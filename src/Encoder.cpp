@@ -0,0 +1,168 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "../include/CompiledSpec.hpp"
+#include "../include/Encoder.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/RV32I.hpp"
+#include "ISATables.hpp"
+
+namespace {
+
+constexpr auto kBuiltinEncodings = compileEncodings(isa::instructions, isa::fields);
+
+constexpr bool allValid(const decltype(kBuiltinEncodings)& encodings) {
+    for (const Encoding& encoding : encodings) {
+        if (!encoding.valid) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(allValid(kBuiltinEncodings), "instructions.txt has an encoding that does not cover 32 bits");
+
+} // namespace
+
+Encoder::Encoder(const std::unordered_map<std::string, std::vector<Token>>& paramMap,
+                 const std::unordered_map<std::string, std::vector<BitField>>& binaryMap)
+{
+    _encodings.reserve(paramMap.size());
+    for (const auto& [name, pattern] : paramMap) {
+        auto bits = binaryMap.find(name);
+        if (bits != binaryMap.end()) {
+            addInstruction(name, pattern, bits->second);
+        }
+    }
+}
+
+Encoder::Encoder(const CompiledSpec& spec) {
+    _encodings.reserve(spec.size());
+    std::vector<isa::FieldLayout> layout;
+    for (std::size_t i = 0; i < spec.size(); ++i) {
+        // Resolve straight from the mapped image, without building BitFields
+        layout.clear();
+        bool ok = true;
+        for (const SpecField& field : spec.fields(i)) {
+            isa::FieldLayout resolved;
+            if (!isa::resolveField(spec.fieldText(field), static_cast<int>(field.bitCount),
+                                   spec.tokens(i), resolved)) {
+                std::cerr << "Encoder: instruction '" << spec.name(i)
+                          << "' has an invalid bit field '" << spec.fieldText(field) << "'\n";
+                ok = false;
+                break;
+            }
+            layout.push_back(resolved);
+        }
+        if (ok) {
+            addLayout(spec.name(i), spec.tokens(i), layout);
+        }
+    }
+}
+
+Encoder Encoder::builtin() {
+    Encoder encoder;
+    encoder._encodings.reserve(isa::kInstructionCount);
+    std::vector<Token> pattern;
+    for (std::size_t op = 0; op < isa::kInstructionCount; ++op) {
+        pattern.clear();
+        for (const isa::OperandPattern& operand : isa::operandsOf(static_cast<isa::Opcode>(op))) {
+            pattern.emplace_back(operand.type, operand.punctuation);
+        }
+        encoder.addEncoding(isa::instructions[op].name, pattern, kBuiltinEncodings[op]);
+    }
+    return encoder;
+}
+
+bool Encoder::addInstruction(std::string_view name, std::span<const Token> pattern,
+                             std::span<const BitField> fields) {
+    std::vector<isa::FieldLayout> layout;
+    layout.reserve(fields.size());
+    for (const BitField& bf : fields) {
+        isa::FieldLayout resolved;
+        if (!isa::resolveField(bf.field, bf.bitCount, pattern, resolved)) {
+            std::cerr << "Encoder: instruction '" << name
+                      << "' has an invalid bit field '" << bf.field << "'\n";
+            return false;
+        }
+        layout.push_back(resolved);
+    }
+    return addLayout(name, pattern, layout);
+}
+
+bool Encoder::addLayout(std::string_view name, std::span<const Token> pattern,
+                        std::span<const isa::FieldLayout> layout) {
+    return addEncoding(name, pattern, compileEncoding(layout));
+}
+
+bool Encoder::addEncoding(std::string_view name, std::span<const Token> pattern,
+                          const Encoding& encoding) {
+    if (!encoding.valid) {
+        std::cerr << "Encoder: instruction '" << name
+                  << "' does not describe a 32-bit encoding\n";
+        return false;
+    }
+
+    auto existing = _ids.find(name);
+    std::size_t id = (existing == _ids.end()) ? _encodings.size() : existing->second;
+    if (!_automaton.add(id, pattern, isPcRelative(encoding))) {
+        std::cerr << "Encoder: instruction '" << name
+                  << "' has an operand pattern the matcher cannot represent\n";
+        return false;
+    }
+
+    // Redefinitions leave the old pattern behind in _patterns; specs are small
+    std::pair<std::uint32_t, std::uint32_t> range(static_cast<std::uint32_t>(_patterns.size()),
+                                                  static_cast<std::uint32_t>(pattern.size()));
+    _patterns.insert(_patterns.end(), pattern.begin(), pattern.end());
+
+    auto [it, inserted] = _ids.try_emplace(std::string(name), _encodings.size());
+    if (inserted) {
+        _encodings.push_back(encoding);
+        _names.emplace_back(name);
+        _patternRanges.push_back(range);
+    } else {
+        _encodings[it->second] = encoding;
+        _patternRanges[it->second] = range;
+    }
+    return true;
+}
+
+std::size_t Encoder::find(std::string_view name) const {
+    auto it = _ids.find(name);
+    return it == _ids.end() ? npos : it->second;
+}
+
+bool Encoder::builtinMnemonicsOnly() const {
+    for (const std::string& name : _names) {
+        const rv32i::Symbol* symbol = rv32i::lookup(name);
+        if (!symbol || symbol->kind != rv32i::SymbolKind::Instruction) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Encoder::encodeAll(std::span<const InstructionRecord> instructions,
+                        std::span<const Token> operands,
+                        std::span<std::uint32_t> out) const {
+    encodeAll(instructions, operands, out, ThreadPool::shared());
+}
+
+void Encoder::encodeAll(std::span<const InstructionRecord> instructions,
+                        std::span<const Token> operands,
+                        std::span<std::uint32_t> out,
+                        ThreadPool& pool) const {
+    // Below this, handing ranges to other threads costs more than encoding
+    const std::size_t kMinRange = 16 * 1024;
+
+    if (out.size() != instructions.size()) {
+        throw std::length_error("Encoder: output buffer does not match the instruction count");
+    }
+
+    pool.parallelForRanges(instructions.size(), kMinRange, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const InstructionRecord& record = instructions[i];
+            out[i] = ::encode(_encodings[record.id], operands.subspan(record.firstOperand));
+        }
+    });
+}
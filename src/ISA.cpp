@@ -0,0 +1,90 @@
+#include <charconv>
+
+#include "../include/ISA.hpp"
+
+namespace isa {
+
+namespace {
+
+// Index of the n-th (1-based) operand of the given type, or -1
+int nthOperand(std::span<const Token> pattern, TokenType type, int n) {
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i].type == type && --n == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool parseNumber(std::string_view text, int& out) {
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+} // namespace
+
+bool resolveField(std::string_view text, int bitCount,
+                  std::span<const Token> pattern, FieldLayout& out) {
+    if (bitCount <= 0 || bitCount > 32) {
+        return false;
+    }
+    out = FieldLayout{static_cast<std::uint8_t>(bitCount), FieldKind::Constant, 0, 0, 0, 0};
+
+    constexpr std::string_view registerPrefix = "register";
+    constexpr std::string_view immediatePrefix = "immediate";
+
+    if (text.substr(0, registerPrefix.size()) == registerPrefix) {
+        int n = 0;
+        if (!parseNumber(text.substr(registerPrefix.size()), n) || n <= 0) {
+            return false;
+        }
+        int operand = nthOperand(pattern, TokenType::REGISTER, n);
+        if (operand < 0) {
+            return false;
+        }
+        out.kind = FieldKind::Register;
+        out.operand = static_cast<std::uint8_t>(operand);
+        return true;
+    }
+
+    if (text.substr(0, immediatePrefix.size()) == immediatePrefix) {
+        int operand = nthOperand(pattern, TokenType::IMMEDIATE, 1);
+        if (operand < 0) {
+            return false;
+        }
+        std::string_view slice = text.substr(immediatePrefix.size());
+        int hi = bitCount - 1, lo = 0;
+        if (!slice.empty()) {
+            // "(H:L)"
+            auto colon = slice.find(':');
+            if (slice.front() != '(' || slice.back() != ')' || colon == std::string_view::npos
+                || !parseNumber(slice.substr(1, colon - 1), hi)
+                || !parseNumber(slice.substr(colon + 1, slice.size() - colon - 2), lo)) {
+                return false;
+            }
+        }
+        if (lo < 0 || hi < lo || hi > 31 || hi - lo + 1 != bitCount) {
+            return false;
+        }
+        out.kind = FieldKind::Immediate;
+        out.operand = static_cast<std::uint8_t>(operand);
+        out.hi = static_cast<std::uint8_t>(hi);
+        out.lo = static_cast<std::uint8_t>(lo);
+        return true;
+    }
+
+    if (text.size() != static_cast<std::size_t>(bitCount)) {
+        return false;
+    }
+    std::uint32_t value = 0;
+    for (char c : text) {
+        if (c != '0' && c != '1') {
+            return false;
+        }
+        value = (value << 1) | static_cast<std::uint32_t>(c - '0');
+    }
+    out.constant = value;
+    return true;
+}
+
+} // namespace isa
@@ -0,0 +1,611 @@
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "../include/Assembler.hpp"
+#include "../include/IncrementalAssembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/Stats.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'F', 'I', 'N', 'C', '\0', '\0', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t npos = UINT32_MAX;
+
+struct CacheHeader {
+    char          magic[8];     // "NFINC\0\0\0"
+    std::uint32_t version;
+    std::uint32_t tokenSize;
+    std::uint64_t fingerprint;  // Of the instruction set the state was built with
+    std::uint64_t lineCount;
+    std::uint64_t tokenCount;
+    std::uint64_t wordCount;
+    std::uint64_t checksum;     // FNV-1a over everything after the header
+};
+
+std::uint64_t fnv1a64(const void* data, std::size_t size,
+                      std::uint64_t h = 14695981039346656037ull) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Replace v[first, last) with 'items'; the tail moves only if the sizes differ
+template <typename T>
+void replaceRange(std::vector<T>& v, std::size_t first, std::size_t last, const std::vector<T>& items) {
+    std::size_t overlap = std::min(last - first, items.size());
+    std::copy_n(items.begin(), overlap, v.begin() + first);
+    if (items.size() > overlap) {
+        v.insert(v.begin() + first + overlap, items.begin() + overlap, items.end());
+    } else {
+        v.erase(v.begin() + first + overlap, v.begin() + last);
+    }
+}
+
+// Add 'delta' (modulo 2^32) to v[first..]
+void addFrom(std::vector<std::uint32_t>& v, std::size_t first, std::uint32_t delta) {
+    if (delta != 0) {
+        for (std::size_t i = first; i < v.size(); ++i) {
+            v[i] += delta;
+        }
+    }
+}
+
+// Line-relative tokens leave their line implicit; diagnostics need it
+Token atLine(Token token, std::size_t lineNo) {
+    token.line = static_cast<std::int32_t>(lineNo + 1);
+    return token;
+}
+
+template <typename T>
+std::uint64_t hashValue(std::uint64_t h, T value) {
+    return fnv1a64(&value, sizeof(value), h);
+}
+
+} // namespace
+
+IncrementalAssembler::IncrementalAssembler(const Encoder& encoder)
+    : _encoder(encoder),
+      _fingerprint(0),
+      _valid(false),
+      _checker(encoder),
+      _indexed(true),
+      _linesRelexed(0),
+      _wordsEncoded(0)
+{
+    _fingerprint = fingerprint();
+    clearState();
+}
+
+// Identity of the instruction set: ids, encodings and operand patterns
+std::uint64_t IncrementalAssembler::fingerprint() const {
+    std::uint64_t h = hashValue(14695981039346656037ull, _encoder.size());
+    for (std::size_t id = 0; id < _encoder.size(); ++id) {
+        const Encoding& encoding = _encoder.encoding(id);
+        h = hashValue(h, encoding.fixedBits);
+        for (std::size_t s = 0; s < encoding.stepCount; ++s) {
+            const EncodeStep& step = encoding.steps[s];
+            h = hashValue(h, step.operand);
+            h = hashValue(h, step.srcShift);
+            h = hashValue(h, step.dstShift);
+            h = hashValue(h, step.mask);
+        }
+        for (const Token& t : _encoder.pattern(id)) {
+            h = hashValue(h, static_cast<std::uint8_t>(t.type));
+            h = hashValue(h, t.value);
+        }
+    }
+    return h;
+}
+
+bool IncrementalAssembler::assemble(std::string_view source) {
+    if (source.size() > UINT32_MAX) {
+        throw std::length_error("Source buffers larger than 4 GiB are not supported");
+    }
+    NF_STATS_PHASE(Assemble);
+    _linesRelexed = 0;
+    _wordsEncoded = 0;
+    _checker.reset();
+    if (!_valid) {
+        clearState();
+    }
+
+    // 1) Split and hash the new source
+    _hashes.clear();
+    _lineStarts.clear();
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    for (const char* p = begin; p < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+        _lineStarts.push_back(static_cast<std::uint32_t>(p - begin));
+        _hashes.push_back(fnv1a64(p, lineEnd - p));
+        p = newline ? newline + 1 : end;
+    }
+    _lineStarts.push_back(static_cast<std::uint32_t>(source.size()));
+
+    // Changed region: everything between the common prefix and suffix
+    std::size_t oldCount = _lines.size();
+    std::size_t newCount = _hashes.size();
+    std::size_t common = std::min(oldCount, newCount);
+    std::size_t prefix = 0;
+    while (prefix < common && _lines[prefix].hash == _hashes[prefix]) {
+        ++prefix;
+    }
+    std::size_t suffix = 0;
+    while (suffix < common - prefix
+           && _lines[oldCount - 1 - suffix].hash == _hashes[newCount - 1 - suffix]) {
+        ++suffix;
+    }
+    std::size_t oldEnd = oldCount - suffix;
+    std::size_t regionCount = newCount - suffix - prefix;
+    std::uint32_t tokenBegin = _lineToken[prefix], tokenEnd = _lineToken[oldEnd];
+    std::uint32_t wordBegin = _lineWord[prefix], wordEnd = _lineWord[oldEnd];
+
+    // 2) Re-lex and re-assemble the region, then splice it in
+    std::vector<LineRecord> lines;
+    std::vector<Token> tokens;
+    std::vector<std::uint32_t> words;
+    assembleRegion(source, _lineStarts, prefix, regionCount, lines, tokens, words);
+
+    std::vector<std::uint32_t> lineToken(regionCount), lineWord(regionCount);
+    std::uint32_t token = tokenBegin, word = wordBegin;
+    for (std::size_t i = 0; i < regionCount; ++i) {
+        lines[i].hash = _hashes[prefix + i];
+        lineToken[i] = token;
+        lineWord[i] = word;
+        token += lines[i].tokenCount;
+        word += (lines[i].flags & HasInstruction) ? 1 : 0;
+    }
+
+    // Where labels sat before the edit, to tell whether any moved
+    std::vector<std::pair<SymbolTable::SymbolId, std::uint32_t>> movedFrom, movedTo;
+    if (_indexed) {
+        auto [first, last] = lineRange(_definitions, prefix, oldEnd);
+        for (auto d = first; d != last; ++d) {
+            movedFrom.emplace_back(d->symbol, _lineWord[d->line]);
+        }
+    }
+
+    // Everything after the region only shifts
+    std::uint32_t lineDelta = static_cast<std::uint32_t>(regionCount - (oldEnd - prefix));
+    std::uint32_t wordDelta = static_cast<std::uint32_t>(words.size()) - (wordEnd - wordBegin);
+    replaceRange(_lines, prefix, oldEnd, lines);
+    replaceRange(_tokens, tokenBegin, tokenEnd, tokens);
+    replaceRange(_words, wordBegin, wordEnd, words);
+    replaceRange(_lineToken, prefix, oldEnd, lineToken);
+    replaceRange(_lineWord, prefix, oldEnd, lineWord);
+    addFrom(_lineToken, prefix + regionCount, static_cast<std::uint32_t>(tokens.size()) - (tokenEnd - tokenBegin));
+    addFrom(_lineWord, prefix + regionCount, wordDelta);
+
+    // 3) Update the label index and fix up label references
+    bool relocated = !_indexed || wordDelta != 0;
+    if (_indexed) {
+        reindexRegion(source, prefix, oldEnd, regionCount, lineDelta);
+        auto [first, last] = lineRange(_definitions, prefix, prefix + regionCount);
+        for (auto d = first; d != last; ++d) {
+            movedTo.emplace_back(d->symbol, _lineWord[d->line]);
+        }
+    } else {
+        reindexAll(source);
+    }
+    relocated |= movedFrom != movedTo;
+
+    // With no label moved relative to the code, only the region's own
+    // references need resolving
+    auto [first, last] = relocated
+        ? std::pair{_references.begin(), _references.end()}
+        : lineRange(_references, prefix, prefix + regionCount);
+    resolveLabels(source, first, last, prefix, prefix + regionCount);
+
+    NF_STATS_ADD(Instructions, _wordsEncoded);
+    NF_STATS_ADD(Errors, _checker.errorCount());
+    _valid = (_checker.errorCount() == 0);
+    return _valid;
+}
+
+bool IncrementalAssembler::assembleRegion(std::string_view source,
+                                          const std::vector<std::uint32_t>& lineStarts,
+                                          std::size_t first, std::size_t count,
+                                          std::vector<LineRecord>& lines,
+                                          std::vector<Token>& tokens,
+                                          std::vector<std::uint32_t>& words) {
+    lines.resize(count);
+    _linesRelexed = count;
+    if (count == 0) {
+        return true;
+    }
+
+    std::uint32_t regionStart = lineStarts[first];
+    std::string_view region = source.substr(regionStart, lineStarts[first + count] - regionStart);
+    std::deque<Token> lexed;
+    Lexer lexer(region, lexed);
+
+    bool ok = true;
+    std::vector<Token> lineTokens;
+    std::size_t current = 0;
+    auto flushUpTo = [&](std::size_t upTo) {
+        for (; current < upTo && current < count; ++current) {
+            std::size_t lineNo = first + current;
+            std::string_view line = source.substr(lineStarts[lineNo],
+                                                  lineStarts[lineNo + 1] - lineStarts[lineNo]);
+            std::size_t tokenStart = tokens.size();
+            tokens.insert(tokens.end(), lineTokens.begin(), lineTokens.end());
+            std::span<Token> stored(tokens.data() + tokenStart, lineTokens.size());
+            ok &= assembleLine(line, lines[current], stored, words);
+            for (Token& token : stored) {
+                token.line = 0;
+            }
+            lineTokens.clear();
+        }
+    };
+
+    for (const Token& token : lexed) {
+        if (token.type == TokenType::EoF) {
+            break;
+        }
+        std::size_t relative = static_cast<std::size_t>(token.line - 1);
+        flushUpTo(relative);
+        if (token.type != TokenType::EoL) {
+            // Offsets become relative to the line. Lines are implicit in the
+            // stored state; they are kept only while the line is checked.
+            std::uint32_t lineOffset = lineStarts[first + relative] - regionStart;
+            lineTokens.emplace_back(token.type, token.offset - lineOffset, token.length,
+                                    static_cast<std::int32_t>(first + relative + 1), token.value);
+        }
+    }
+    flushUpTo(count);
+    return ok;
+}
+
+bool IncrementalAssembler::assembleLine(std::string_view line, LineRecord& record, std::span<Token> lineTokens,
+                                        std::vector<std::uint32_t>& words) {
+    record = LineRecord{0, npos, static_cast<std::uint16_t>(lineTokens.size()), 0, 0};
+    if (lineTokens.size() > UINT16_MAX) {
+        _checker.error(line, lineTokens.front(), "Too many tokens on one line");
+        record.tokenCount = 0;
+        return false;
+    }
+
+    std::size_t i = 0;
+    while (i < lineTokens.size() && lineTokens[i].type == TokenType::LABEL) {
+        ++i;
+    }
+    if (i == lineTokens.size()) {
+        return true;
+    }
+
+    // Same checks and messages as a full build
+    const Token& instruction = lineTokens[i];
+    if (instruction.type != TokenType::INSTRUCTION) {
+        _checker.reportUnexpected(line, instruction);
+        return false;
+    }
+    if (i > UINT8_MAX) {
+        _checker.error(line, instruction, "Too many labels on one line");
+        return false;
+    }
+    std::span<const Token> operands = lineTokens.subspan(i + 1);
+    std::size_t id;
+    std::uint32_t labelMask;
+    if (!_checker.checkInstruction(line, instruction, operands, id, labelMask)) {
+        return false;
+    }
+    for (const Token& operand : operands) {
+        if (operand.type == TokenType::IMMEDIATE && !_checker.checkImmediate(line, operand, id)) {
+            return false;
+        }
+    }
+
+    bool hasReference = labelMask != 0;
+    record.encoderId = static_cast<std::uint32_t>(id);
+    record.instructionToken = static_cast<std::uint8_t>(i);
+    record.flags = HasInstruction | (hasReference ? HasReference : 0);
+
+    // Label operands are filled in by resolveLabels()
+    words.push_back(hasReference ? 0 : ::encode(_encoder.encoding(id), operands));
+    _wordsEncoded += hasReference ? 0 : 1;
+    return true;
+}
+
+std::string_view IncrementalAssembler::lineText(std::string_view source, std::size_t line) const {
+    return source.substr(_lineStarts[line], _lineStarts[line + 1] - _lineStarts[line]);
+}
+
+void IncrementalAssembler::clearState() {
+    _lines.clear();
+    _tokens.clear();
+    _words.clear();
+    _lineToken.assign(1, 0);
+    _lineWord.assign(1, 0);
+    _symbols.clear();
+    _labels.clear();
+    _definitions.clear();
+    _references.clear();
+    _indexed = true;
+}
+
+std::pair<IncrementalAssembler::LabelUses::iterator, IncrementalAssembler::LabelUses::iterator>
+IncrementalAssembler::lineRange(LabelUses& uses, std::size_t firstLine, std::size_t lastLine) {
+    auto before = [](const LabelUse& use, std::size_t line) { return use.line < line; };
+    auto first = std::lower_bound(uses.begin(), uses.end(), firstLine, before);
+    return {first, std::lower_bound(first, uses.end(), lastLine, before)};
+}
+
+// Label definitions and references of lines [first, last), in line order
+void IncrementalAssembler::indexLines(std::string_view source, std::size_t first, std::size_t last,
+                                      LabelUses& definitions, LabelUses& references) {
+    for (std::size_t l = first; l < last; ++l) {
+        const LineRecord& record = _lines[l];
+        std::string_view line = lineText(source, l);
+        const Token* tokens = _tokens.data() + _lineToken[l];
+        std::size_t labels = (record.flags & HasInstruction) ? record.instructionToken : record.tokenCount;
+        for (std::uint32_t k = 0; k < labels; ++k) {
+            if (tokens[k].type == TokenType::LABEL) {
+                std::string_view name = tokens[k].lexeme(line);
+                name.remove_suffix(1);      // Trailing ':'
+                definitions.push_back(LabelUse{static_cast<std::uint32_t>(l), k, _symbols.intern(name)});
+            }
+        }
+        if (record.flags & HasReference) {
+            for (std::uint32_t k = record.instructionToken + 1u; k < record.tokenCount; ++k) {
+                if (tokens[k].type == TokenType::ERROR) {
+                    references.push_back(LabelUse{static_cast<std::uint32_t>(l), k,
+                                                  _symbols.intern(tokens[k].lexeme(line))});
+                }
+            }
+        }
+    }
+    _labels.resize(_symbols.size(), LabelUse{npos, 0, 0});
+}
+
+// Replace the index entries of old lines [first, oldEnd) with those of the
+// new lines [first, first + count); later entries move by 'lineDelta'
+void IncrementalAssembler::reindexRegion(std::string_view source, std::size_t first, std::size_t oldEnd,
+                                         std::size_t count, std::uint32_t lineDelta) {
+    auto [defFirst, defLast] = lineRange(_definitions, first, oldEnd);
+    for (auto d = defFirst; d != defLast; ++d) {
+        _labels[d->symbol].line = npos;
+    }
+    std::size_t defBegin = defFirst - _definitions.begin(), defEnd = defLast - _definitions.begin();
+    auto [refFirst, refLast] = lineRange(_references, first, oldEnd);
+    std::size_t refBegin = refFirst - _references.begin(), refEnd = refLast - _references.begin();
+
+    LabelUses definitions, references;
+    indexLines(source, first, first + count, definitions, references);
+    replaceRange(_references, refBegin, refEnd, references);
+    replaceRange(_definitions, defBegin, defEnd, definitions);
+    if (lineDelta != 0) {
+        for (std::size_t r = refBegin + references.size(); r < _references.size(); ++r) {
+            _references[r].line += lineDelta;
+        }
+        for (std::size_t d = defBegin + definitions.size(); d < _definitions.size(); ++d) {
+            _definitions[d].line += lineDelta;
+            _labels[_definitions[d].symbol].line = _definitions[d].line;
+        }
+    }
+    for (const LabelUse& definition : definitions) {
+        defineLabel(source, definition);
+    }
+}
+
+// Index every line; the first run after load() has no index to update
+void IncrementalAssembler::reindexAll(std::string_view source) {
+    _symbols.clear();
+    _labels.clear();
+    _definitions.clear();
+    _references.clear();
+    indexLines(source, 0, _lines.size(), _definitions, _references);
+    for (const LabelUse& definition : _definitions) {
+        defineLabel(source, definition);
+    }
+    _indexed = true;
+}
+
+void IncrementalAssembler::defineLabel(std::string_view source, const LabelUse& definition) {
+    LabelUse& label = _labels[definition.symbol];
+    if (label.line == npos) {
+        label = definition;
+        return;
+    }
+    // Report the later of the two, as a full build would
+    const LabelUse& duplicate = (definition.line > label.line) ? definition : label;
+    std::string_view line = lineText(source, duplicate.line);
+    const Token& token = _tokens[_lineToken[duplicate.line] + duplicate.token];
+    _checker.error(line, atLine(token, duplicate.line),
+                   "Label '" + std::string(_symbols.name(definition.symbol)) + "' is already defined");
+}
+
+// Resolve references [first, last) (in line order) and re-encode the lines
+// whose PC-relative offsets changed, or that lie in the changed region
+bool IncrementalAssembler::resolveLabels(std::string_view source,
+                                         LabelUses::const_iterator first, LabelUses::const_iterator last,
+                                         std::size_t regionBegin, std::size_t regionEnd) {
+    bool ok = true;
+    while (first != last) {
+        std::uint32_t l = first->line;
+        const LineRecord& record = _lines[l];
+        std::string_view line = lineText(source, l);
+        std::uint32_t pc = _lineWord[l] * 4;
+        bool changed = (l >= regionBegin && l < regionEnd);
+        bool lineOk = true;
+        for (; first != last && first->line == l; ++first) {
+            Token& operand = _tokens[_lineToken[l] + first->token];
+            const LabelUse& label = _labels[first->symbol];
+            if (label.line == npos) {
+                _checker.error(line, atLine(operand, l),
+                               "Undefined label '" + std::string(operand.lexeme(line)) + "'");
+                lineOk = false;
+                continue;
+            }
+            auto offset = static_cast<std::int32_t>(_lineWord[label.line] * 4) - static_cast<std::int32_t>(pc);
+            if (offset != operand.value) {
+                operand.value = offset;
+                changed = true;
+            }
+            Token resolved = atLine(operand, l);
+            if (!_checker.checkImmediate(line, resolved, record.encoderId)) {
+                lineOk = false;
+            }
+        }
+        if (changed && lineOk) {
+            std::span<const Token> operands(_tokens.data() + _lineToken[l] + record.instructionToken + 1,
+                                            record.tokenCount - record.instructionToken - 1u);
+            _words[_lineWord[l]] = ::encode(_encoder.encoding(record.encoderId), operands);
+            ++_wordsEncoded;
+        }
+        ok &= lineOk;
+    }
+    return ok;
+}
+
+void IncrementalAssembler::exportSymbols(SymbolTable& out) const {
+    out.clear();
+    if (!_valid || !_indexed) {
+        return;
+    }
+    // Definitions and references merged back into source order
+    auto before = [](const LabelUse& a, const LabelUse& b) {
+        return a.line != b.line ? a.line < b.line : a.token < b.token;
+    };
+    auto d = _definitions.begin(), r = _references.begin();
+    while (d != _definitions.end() || r != _references.end()) {
+        if (r == _references.end() || (d != _definitions.end() && before(*d, *r))) {
+            out.define(out.intern(_symbols.name(d->symbol)), _lineWord[d->line] * 4);
+            ++d;
+        } else {
+            out.intern(_symbols.name(r->symbol));
+            ++r;
+        }
+    }
+}
+
+bool IncrementalAssembler::save(const std::string& cachePath) const {
+    if (!_valid) {
+        return false;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.tokenSize = sizeof(Token);
+    header.fingerprint = _fingerprint;
+    header.lineCount = _lines.size();
+    header.tokenCount = _tokens.size();
+    header.wordCount = _words.size();
+    std::uint64_t h = fnv1a64(_lines.data(), _lines.size() * sizeof(LineRecord));
+    h = fnv1a64(_tokens.data(), _tokens.size() * sizeof(Token), h);
+    header.checksum = fnv1a64(_words.data(), _words.size() * sizeof(std::uint32_t), h);
+
+    // Temporary file and rename, so a crash never leaves a torn cache
+    std::string tmp = cachePath + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(_lines.data()),
+                  static_cast<std::streamsize>(_lines.size() * sizeof(LineRecord)));
+        out.write(reinterpret_cast<const char*>(_tokens.data()),
+                  static_cast<std::streamsize>(_tokens.size() * sizeof(Token)));
+        out.write(reinterpret_cast<const char*>(_words.data()),
+                  static_cast<std::streamsize>(_words.size() * sizeof(std::uint32_t)));
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool IncrementalAssembler::load(const std::string& cachePath) {
+    _valid = false;
+    clearState();
+
+    MappedFile file;
+    try {
+        file = MappedFile(cachePath);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+
+    CacheHeader header;
+    if (file.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+        || header.version != kVersion
+        || header.tokenSize != sizeof(Token)
+        || header.fingerprint != _fingerprint
+        || header.lineCount > file.size() || header.tokenCount > file.size()
+        || header.wordCount > file.size()) {
+        return false;
+    }
+    std::size_t linesBytes = header.lineCount * sizeof(LineRecord);
+    std::size_t tokensBytes = header.tokenCount * sizeof(Token);
+    std::size_t wordsBytes = header.wordCount * sizeof(std::uint32_t);
+    if (file.size() != sizeof(header) + linesBytes + tokensBytes + wordsBytes) {
+        return false;
+    }
+    const char* payload = file.data() + sizeof(header);
+    std::uint64_t h = fnv1a64(payload, linesBytes);
+    h = fnv1a64(payload + linesBytes, tokensBytes, h);
+    h = fnv1a64(payload + linesBytes + tokensBytes, wordsBytes, h);
+    if (h != header.checksum) {
+        return false;
+    }
+
+    std::vector<LineRecord> lines(header.lineCount);
+    std::vector<Token> tokens(header.tokenCount, Token(TokenType::ERROR));
+    std::vector<std::uint32_t> words(header.wordCount);
+    std::memcpy(lines.data(), payload, linesBytes);
+    std::memcpy(static_cast<void*>(tokens.data()), payload + linesBytes, tokensBytes);
+    std::memcpy(words.data(), payload + linesBytes + tokensBytes, wordsBytes);
+
+    // The records must be consistent with each other before they are trusted
+    std::vector<std::uint32_t> lineToken, lineWord;
+    lineToken.reserve(lines.size() + 1);
+    lineWord.reserve(lines.size() + 1);
+    std::size_t tokenTotal = 0, instructionTotal = 0;
+    for (const LineRecord& record : lines) {
+        lineToken.push_back(static_cast<std::uint32_t>(tokenTotal));
+        lineWord.push_back(static_cast<std::uint32_t>(instructionTotal));
+        if (record.flags & HasInstruction) {
+            if (record.encoderId >= _encoder.size() || record.instructionToken >= record.tokenCount) {
+                return false;
+            }
+            ++instructionTotal;
+        }
+        tokenTotal += record.tokenCount;
+    }
+    if (tokenTotal != tokens.size() || instructionTotal != words.size()) {
+        return false;
+    }
+    lineToken.push_back(static_cast<std::uint32_t>(tokenTotal));
+    lineWord.push_back(static_cast<std::uint32_t>(instructionTotal));
+
+    // The label index needs the source text; the next assemble() builds it
+    _lines = std::move(lines);
+    _tokens = std::move(tokens);
+    _words = std::move(words);
+    _lineToken = std::move(lineToken);
+    _lineWord = std::move(lineWord);
+    _indexed = false;
+    _valid = true;
+    return true;
+}
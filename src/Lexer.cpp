@@ -1,84 +1,358 @@
+#include <algorithm>
 #include <deque>
 #include <fstream>
-#include <regex>
 #include <string>
 #include <stdexcept>
 #include <iostream>
 #include <unordered_set>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
 
 #include "../include/Lexer.hpp"
+#include "../include/CharScan.hpp"
+#include "../include/LookupKey.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/RV32I.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ThreadPool.hpp"
 
-Lexer::Lexer(std::ifstream& source,
-             std::deque<Token>& parsedFileRef,
-             const std::unordered_set<std::string>& instructionsSet,
-             const std::unordered_set<std::string>& punctuationSet)
+namespace {
+
+inline std::uint32_t hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') return static_cast<std::uint32_t>(c - '0');
+    return static_cast<std::uint32_t>((c | 0x20) - 'a' + 10);
+}
+
+} // namespace
+
+bool isLabelName(std::string_view name) {
+    auto isLetter = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+    if (name.empty() || !isLetter(name[0])) {
+        return false;
+    }
+    for (char c : name) {
+        if (!isLetter(c) && !(c >= '0' && c <= '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Lexer::Lexer(std::deque<Token>& parsedFileRef,
+             const std::unordered_set<std::string>* instructionsSet,
+             const std::unordered_set<std::string>* punctuationSet,
+             LexMode lexMode)
     : currentLine(1),
-      currentColumn(1),
       parsedFile(parsedFileRef),
       instructions(instructionsSet),
-      punctuations(punctuationSet)
+      punctuations(punctuationSet),
+      mode(lexMode)
 {
+}
+
+Lexer::Lexer(std::ifstream& source,
+             std::deque<Token>& parsedFileRef,
+             const std::unordered_set<std::string>& instructionsSet,
+             const std::unordered_set<std::string>& punctuationSet,
+             LexMode lexMode)
+    : Lexer(parsedFileRef, &instructionsSet, &punctuationSet, lexMode)
+{
+    readStream(source);
+    scanBuffer();
+}
+
+Lexer::Lexer(std::string_view source,
+             std::deque<Token>& parsedFileRef,
+             const std::unordered_set<std::string>& instructionsSet,
+             const std::unordered_set<std::string>& punctuationSet,
+             LexMode lexMode)
+    : Lexer(parsedFileRef, &instructionsSet, &punctuationSet, lexMode)
+{
+    sourceBuffer = source;
+    scanBuffer();
+}
+
+Lexer::Lexer(const MappedFile& source,
+             std::deque<Token>& parsedFileRef,
+             const std::unordered_set<std::string>& instructionsSet,
+             const std::unordered_set<std::string>& punctuationSet,
+             LexMode lexMode)
+    : Lexer(source.view(), parsedFileRef, instructionsSet, punctuationSet, lexMode)
+{
+}
+
+// Built-in RV32I vocabulary: no sets, classification goes through the
+// compile-time tables in RV32I.hpp
+Lexer::Lexer(std::ifstream& source, std::deque<Token>& parsedFileRef, LexMode lexMode)
+    : Lexer(parsedFileRef, nullptr, nullptr, lexMode)
+{
+    readStream(source);
+    scanBuffer();
+}
+
+Lexer::Lexer(std::string_view source, std::deque<Token>& parsedFileRef, LexMode lexMode)
+    : Lexer(parsedFileRef, nullptr, nullptr, lexMode)
+{
+    sourceBuffer = source;
+    scanBuffer();
+}
+
+Lexer::Lexer(const MappedFile& source, std::deque<Token>& parsedFileRef, LexMode lexMode)
+    : Lexer(source.view(), parsedFileRef, lexMode)
+{
+}
+
+void Lexer::readStream(std::ifstream& source) {
     if (!source.is_open()) {
         throw std::runtime_error("Source file not found!");
     }
 
-    std::string line;
-    // Regex to capture tokens, including possible trailing colons (labels),
-    // plus parentheses. Adjust as needed for your use case.
-    std::regex re("([a-zA-Z0-9_]+:|[a-zA-Z0-9_]+|\\(|\\))", std::regex_constants::optimize);
+    // Pull the whole file in with one read instead of a copy per line
+    source.seekg(0, std::ios::end);
+    std::streamoff size = source.tellg();
+    source.seekg(0, std::ios::beg);
+    if (size > 0) {
+        ownedSource.resize(static_cast<size_t>(size));
+        source.read(ownedSource.data(), size);
+        ownedSource.resize(static_cast<size_t>(source.gcount()));
+    } else {
+        ownedSource.assign(std::istreambuf_iterator<char>(source),
+                           std::istreambuf_iterator<char>());
+    }
+    sourceBuffer = ownedSource;
+}
+
+// ------------------------
+// Line scanner
+// ------------------------
+// Hand-coded state machine equivalent to the old
+//   ([a-zA-Z0-9_]+:|[a-zA-Z0-9_]+|\(|\))
+// regex: a maximal run of word characters, optionally followed by a single
+// ':' (label), or a lone parenthesis. A '-' starts a token of its own,
+// taking the word run right after it ("-4"), so a negative immediate is
+// never read as its magnitude. Everything else is skipped. The runs
+// themselves are found with the vectorized helpers in CharScan.hpp.
+//
+// Scans the line starting at 'line', appends its tokens and EoL to 'out'
+// and returns the start of the next line. Line splitting follows
+// std::getline: a trailing newline does not start an extra empty line, and
+// a missing final newline still ends the last line.
+template <typename Container>
+const char* Lexer::scanLine(const char* line, const char* end, int lineNo, Container& out) const {
+    const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    const char* lineEnd = newline ? newline : end;
+    // The run finders may look past the line end: '\n' stops both of them,
+    // and letting them see the rest of the buffer keeps them on wide loads
+    const char* bufferEnd = sourceBuffer.data() + sourceBuffer.size();
+    const char* pos = line;
+    const char* lastToken = line;
 
-    while (std::getline(source, line)) {
-        auto lineStart = line.data(); // Pointer to the start of the line
-        std::sregex_iterator it(line.begin(), line.end(), re);
-        std::sregex_iterator end;
+    while (true) {
+        pos = findTokenStart(pos, bufferEnd);
+        if (pos >= lineEnd) {
+            break;
+        }
+        lastToken = pos;
 
-        for (; it != end; ++it) {
-            const std::smatch& match = *it;
+        if (charClassOf(*pos) == CC_WORD) {
+            const char* start = pos;
+            pos = findWordEnd(pos + 1, bufferEnd);
 
-            // Position & length of the token in this line
-            int tokenPosition = match.position(0);
-            int tokenLength   = match.length(0);
+            // A trailing colon belongs to the token (label definition)
+            if (pos < lineEnd && *pos == ':') {
+                ++pos;
+            }
 
-            // Update currentColumn; columns start at 1
-            currentColumn = tokenPosition + 1;
+            out.push_back(tokenize(start, static_cast<size_t>(pos - start), lineNo));
+        }
+        else if (charClassOf(*pos) == CC_MINUS) {
+            // "-4" is one token; a '-' not followed by a word is an ERROR
+            const char* start = pos;
+            ++pos;
+            if (pos < lineEnd && charClassOf(*pos) == CC_WORD) {
+                pos = findWordEnd(pos + 1, bufferEnd);
+            }
+            out.push_back(tokenize(start, static_cast<size_t>(pos - start), lineNo));
+        }
+        else {
+            // '(' or ')'
+            out.push_back(tokenize(pos, 1, lineNo));
+            ++pos;
+        }
+    }
 
-            // Get a pointer to the token substring within the line
-            const char* tokenStr = lineStart + tokenPosition;
+    // After each line, we add an EoL token. It sits at the column of the
+    // last token on the line (or column 1 for an empty line).
+    out.emplace_back(TokenType::EoL, offsetOf(lastToken), 1, lineNo);
 
-            // Tokenize and push the token
-            Token tok = tokenize(tokenStr, tokenLength, currentLine, currentColumn);
-            parsedFile.push_back(std::move(tok));
+    return newline ? newline + 1 : end;
+}
+
+// ------------------------
+// Buffer scanner
+// ------------------------
+void Lexer::scanBuffer() {
+    // Token offsets are 32-bit
+    if (sourceBuffer.size() > UINT32_MAX) {
+        throw std::length_error("Source buffer larger than 4 GiB.");
+    }
+
+    scanPos = 0;
+    eofEmitted = false;
+    NF_STATS_ADD(BytesRead, sourceBuffer.size());
+
+    // Streaming mode scans lazily from fillWindow()
+    if (mode == LexMode::Eager) {
+        NF_STATS_PHASE(Lex);
+        [[maybe_unused]] std::size_t before = parsedFile.size();
+        while (scanNextLine()) {
         }
+        NF_STATS_ADD(Tokens, parsedFile.size() - before);
+    }
+    else if (mode == LexMode::Parallel) {
+        NF_STATS_PHASE(Lex);
+        [[maybe_unused]] std::size_t before = parsedFile.size();
+        scanParallel();
+        NF_STATS_ADD(Tokens, parsedFile.size() - before);
+    }
+}
 
-        // After each line, we add an EoL token
-        parsedFile.emplace_back(TokenType::EoL, "\n", currentLine, currentColumn);
+// Scan the next line (tokens + EoL), or emit EoF once the buffer is
+// exhausted. Returns false when there is nothing left to produce.
+bool Lexer::scanNextLine() const {
+    const char* pos = sourceBuffer.data() + scanPos;
+    const char* end = sourceBuffer.data() + sourceBuffer.size();
 
+    if (pos < end) {
+        scanPos = offsetOf(scanLine(pos, end, currentLine, parsedFile));
         // Move to the next line
         currentLine++;
-        currentColumn = 1;
+        return true;
+    }
+
+    if (!eofEmitted) {
+        // Finally, add an EoF token
+        parsedFile.emplace_back(TokenType::EoF, offsetOf(end), 0, currentLine);
+        eofEmitted = true;
+        return true;
+    }
+    return false;
+}
+
+// Streaming mode: top the window up with the next line once it runs dry
+void Lexer::fillWindow() const {
+    if (parsedFile.empty()) {
+        while (parsedFile.empty() && scanNextLine()) {
+        }
+        NF_STATS_ADD(Tokens, parsedFile.size());
+    }
+}
+
+// ------------------------
+// Parallel scanner
+// ------------------------
+// No token spans a newline, so the buffer is cut into chunks at line
+// boundaries and each chunk is lexed on the shared thread pool into its own
+// token vector, numbering its lines from 1. The chunks are then appended in
+// order, shifting each chunk's line numbers by the lines before it. Offsets
+// are absolute already, since every chunk points into the same buffer.
+void Lexer::scanParallel() {
+    const size_t kMinChunkBytes = 64 * 1024;
+
+    ThreadPool& pool = ThreadPool::shared();
+    const char* begin = sourceBuffer.data();
+    const char* end = begin + sourceBuffer.size();
+
+    size_t chunkCount = std::min<size_t>(static_cast<size_t>(pool.size() + 1) * 4,
+                                         sourceBuffer.size() / kMinChunkBytes);
+    if (chunkCount <= 1) {
+        while (scanNextLine()) {
+        }
+        return;
+    }
+
+    // Chunk k covers [bounds[k], bounds[k + 1]); each bound starts a line
+    std::vector<const char*> bounds{begin};
+    for (size_t k = 1; k < chunkCount; ++k) {
+        const char* target = begin + sourceBuffer.size() * k / chunkCount;
+        if (target <= bounds.back()) {
+            continue;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+        if (!newline || newline + 1 >= end) {
+            break;
+        }
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(end);
+
+    struct Chunk {
+        std::vector<Token> tokens;
+        int lines = 0;
+    };
+    std::vector<Chunk> chunks(bounds.size() - 1);
+
+    pool.parallelFor(chunks.size(), [&](size_t k) {
+        Chunk& chunk = chunks[k];
+        // Rough guess to avoid most regrowth: one token per 4 bytes
+        chunk.tokens.reserve(static_cast<size_t>(bounds[k + 1] - bounds[k]) / 4 + 1);
+        const char* pos = bounds[k];
+        while (pos < bounds[k + 1]) {
+            pos = scanLine(pos, bounds[k + 1], ++chunk.lines, chunk.tokens);
+        }
+    });
+
+    int lineBase = 0;
+    for (Chunk& chunk : chunks) {
+        for (Token& token : chunk.tokens) {
+            token.line += lineBase;
+            parsedFile.push_back(token);
+        }
+        lineBase += chunk.lines;
+        std::vector<Token>().swap(chunk.tokens);
     }
 
-    // Finally, add an EoF token
-    parsedFile.emplace_back(TokenType::EoF, "EOF", currentLine, currentColumn);
+    currentLine = lineBase + 1;
+    scanPos = offsetOf(end);
+    scanNextLine();     // EoF
 }
 
-Token Lexer::tokenize(const char* str, size_t length, int line, int column) {
+Token Lexer::tokenize(const char* str, size_t length, int line) const {
     TokenType type = TokenType::ERROR; // Default
+    std::int32_t value = 0;
+    std::uint32_t offset = offsetOf(str);
+
+    // Lexeme lengths are 16-bit; anything longer cannot be a valid token
+    if (length > UINT16_MAX) {
+        return Token(type, offset, UINT16_MAX, line);
+    }
 
-    // We could use std::string_view in C++17+ for no-copy
-    std::string tokenLexeme(str, length);
+    std::string_view word(str, length);
+    // One perfect-hash probe covers mnemonics and register names. Custom
+    // instruction sets keep their own vocabulary and only take x0..x31.
+    const rv32i::Symbol* symbol = builtinWords() ? rv32i::lookup(word) : nullptr;
 
     // 1) Check punctuation first
-    if (punctuations.find(tokenLexeme) != punctuations.end()) {
+    if (isPunctuation(word)) {
         // "(" or ")" or ":" etc.
         type = TokenType::PUNCTUATION;
+        value = static_cast<unsigned char>(str[0]);
     }
     // 2) Check if the token is an instruction
-    else if (instructions.find(tokenLexeme) != instructions.end()) {
+    else if (isInstruction(word, symbol)) {
         type = TokenType::INSTRUCTION;
+        // Built-in mnemonics carry their id; custom sets have none
+        value = builtinWords() ? symbol->value : 0;
     }
-    // 3) Check register (x0..x31)
+    // 3) Check register (x0..x31, and ABI names with the built-in tables)
+    else if (symbol && symbol->kind == rv32i::SymbolKind::Register) {
+        type = TokenType::REGISTER;
+        value = symbol->value;
+    }
+    // Spellings outside the table, e.g. "x07"
     else if (length >= 2 && str[0] == 'x') {
         bool valid = true;
         int regNum = 0;
@@ -95,21 +369,29 @@ Token Lexer::tokenize(const char* str, size_t length, int line, int column) {
         }
         if (valid) {
             type = TokenType::REGISTER;
+            value = regNum;
         }
     }
-    // 4) Check immediate (binary, hex, decimal)
+    // 4) Check immediate (binary, hex, decimal). Binary and hex spell a
+    //    32-bit pattern (0xFFFFFFFF is -1); decimals, optionally with a
+    //    leading '-', must fit an int32. Anything that overflows stays an
+    //    ERROR token.
     else if (length > 0) {
         // Shortcut references
         const char* s = str;
+        std::uint64_t imm = 0;
+        std::uint64_t limit = UINT32_MAX;
 
         // a) binary immediate: 0bxxxx
         if (length > 2 && s[0] == '0' && s[1] == 'b') {
             bool valid = true;
-            for (size_t i = 2; i < length; ++i) {
+            for (size_t i = 2; i < length && valid; ++i) {
                 if (s[i] != '0' && s[i] != '1') {
                     valid = false;
                     break;
                 }
+                imm = (imm << 1) | static_cast<std::uint64_t>(s[i] - '0');
+                valid = imm <= limit;
             }
             if (valid) {
                 type = TokenType::IMMEDIATE;
@@ -118,54 +400,62 @@ Token Lexer::tokenize(const char* str, size_t length, int line, int column) {
         // b) hex immediate: 0x....
         else if (length > 2 && s[0] == '0' && s[1] == 'x') {
             bool valid = true;
-            for (size_t i = 2; i < length; ++i) {
+            for (size_t i = 2; i < length && valid; ++i) {
                 if (!std::isxdigit(static_cast<unsigned char>(s[i]))) {
                     valid = false;
                     break;
                 }
+                imm = (imm << 4) | hexDigitValue(s[i]);
+                valid = imm <= limit;
             }
             if (valid) {
                 type = TokenType::IMMEDIATE;
             }
         }
-        // c) decimal immediate: all digits
+        // c) decimal immediate: '-'? followed by digits
         else {
-            bool allDigits = true;
-            for (size_t i = 0; i < length; ++i) {
+            bool negative = s[0] == '-';
+            size_t first = negative ? 1 : 0;
+            limit = negative ? std::uint64_t{1} << 31 : INT32_MAX;
+            bool valid = length > first;
+            for (size_t i = first; i < length && valid; ++i) {
                 if (!std::isdigit(static_cast<unsigned char>(str[i]))) {
-                    allDigits = false;
+                    valid = false;
                     break;
                 }
+                imm = imm * 10 + static_cast<std::uint64_t>(str[i] - '0');
+                valid = imm <= limit;
             }
-            if (allDigits) {
+            if (valid) {
                 type = TokenType::IMMEDIATE;
+                if (negative) {
+                    imm = ~imm + 1;     // Two's complement; -2^31 stays in range
+                }
             }
         }
+
+        if (type == TokenType::IMMEDIATE) {
+            value = static_cast<std::int32_t>(static_cast<std::uint32_t>(imm));
+        }
     }
 
-    // 5) Check label: must end in ':' and not contain underscores (per your note)
+    // 5) Check label: a label name followed by ':'
     //    We'll do it *after* the immediate checks, so it doesn't conflict with numeric tokens that happen to have a trailing colon (unusual, but just in case).
-    if (type == TokenType::ERROR && length > 0 && str[length - 1] == ':') {
-        bool hasUnderscore = false;
-        for (size_t i = 0; i < length - 1; ++i) {
-            if (str[i] == '_') {
-                hasUnderscore = true;
-                break;
-            }
-        }
-        if (!hasUnderscore) {
-            type = TokenType::LABEL;
-        }
+    if (type == TokenType::ERROR && length > 1 && str[length - 1] == ':'
+        && isLabelName(word.substr(0, length - 1))) {
+        type = TokenType::LABEL;
     }
 
-    return Token(type, std::move(tokenLexeme), line, column);
+    return Token(type, offset, static_cast<std::uint16_t>(length), line, value);
 }
 
 bool Lexer::hasMoreTokens() const {
+    fillWindow();
     return !parsedFile.empty();
 }
 
 const Token& Lexer::peekNextToken() const {
+    fillWindow();
     if (parsedFile.empty()) {
         throw std::out_of_range("No tokens available to peek.");
     }
@@ -173,6 +463,7 @@ const Token& Lexer::peekNextToken() const {
 }
 
 Token Lexer::getNextToken() {
+    fillWindow();
     if (parsedFile.empty()) {
         throw std::out_of_range("No tokens available.");
     }
@@ -181,6 +472,32 @@ Token Lexer::getNextToken() {
     return nextToken;
 }
 
+bool Lexer::isPunctuation(std::string_view word) const {
+    if (builtinWords()) {
+        return word.size() == 1 && (word[0] == '(' || word[0] == ')' || word[0] == ':');
+    }
+    return punctuations->find(lookupKey(word)) != punctuations->end();
+}
+
+bool Lexer::isInstruction(std::string_view word, const rv32i::Symbol* symbol) const {
+    if (builtinWords()) {
+        return symbol && symbol->kind == rv32i::SymbolKind::Instruction;
+    }
+    return instructions->find(lookupKey(word)) != instructions->end();
+}
+
+bool Lexer::builtinWords() const {
+    return instructions == nullptr;
+}
+
+std::string_view Lexer::lexeme(const Token& token) const {
+    return token.lexeme(sourceBuffer);
+}
+
+int Lexer::column(const Token& token) const {
+    return token.column(sourceBuffer);
+}
+
 void Lexer::printTokens() const {
     for (const auto& tok : parsedFile) {
         std::string typeStr;
@@ -194,7 +511,7 @@ void Lexer::printTokens() const {
             case TokenType::EoF:           typeStr = "EoF";           break;
             case TokenType::ERROR:         typeStr = "ERROR";         break;
         }
-        std::cout << "Token: \"" << tok.lexeme << "\", Type: " << typeStr
-                  << ", Line: " << tok.line << ", Column: " << tok.column << "\n";
+        std::cout << "Token: \"" << lexeme(tok) << "\", Type: " << typeStr
+                  << ", Line: " << tok.line << ", Column: " << column(tok) << "\n";
     }
 }
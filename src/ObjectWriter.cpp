@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../include/ObjectWriter.hpp"
+#include "../include/Stats.hpp"
+#include "../include/SymbolTable.hpp"
+
+namespace {
+
+// ELF32 constants used here (see the System V ABI and the RISC-V psABI)
+constexpr std::size_t kEhdrSize = 52;
+constexpr std::size_t kShdrSize = 40;
+constexpr std::size_t kSymSize = 16;
+constexpr std::uint16_t kTypeRel = 1;
+constexpr std::uint16_t kMachineRiscv = 243;
+constexpr std::uint32_t kShtProgbits = 1;
+constexpr std::uint32_t kShtSymtab = 2;
+constexpr std::uint32_t kShtStrtab = 3;
+constexpr std::uint32_t kShfWrite = 0x1;
+constexpr std::uint32_t kShfAlloc = 0x2;
+constexpr std::uint32_t kShfExecinstr = 0x4;
+constexpr std::uint8_t kSttSection = 3;
+
+// Section indices and their names in .shstrtab
+enum Section : std::uint16_t { Null, Text, Data, Symtab, Strtab, Shstrtab, SectionCount };
+constexpr std::string_view kSectionNames("\0.text\0.data\0.symtab\0.strtab\0.shstrtab\0", 39);
+constexpr std::uint32_t kSectionNameOffsets[SectionCount] = {0, 1, 7, 13, 21, 29};
+
+// Little-endian stores into a byte buffer
+void put16(char* at, std::uint16_t value) {
+    at[0] = static_cast<char>(value & 0xFF);
+    at[1] = static_cast<char>(value >> 8);
+}
+
+void put32(char* at, std::uint32_t value) {
+    for (int b = 0; b < 4; ++b) {
+        at[b] = static_cast<char>((value >> (8 * b)) & 0xFF);
+    }
+}
+
+struct SectionHeader {
+    std::uint32_t type = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+    std::uint32_t link = 0;
+    std::uint32_t info = 0;
+    std::uint32_t align = 0;
+    std::uint32_t entsize = 0;
+};
+
+void putSectionHeader(char* at, std::uint32_t name, const SectionHeader& header) {
+    put32(at, name);
+    put32(at + 4, header.type);
+    put32(at + 8, header.flags);
+    put32(at + 12, 0);      // sh_addr: not loaded at a fixed address
+    put32(at + 16, header.offset);
+    put32(at + 20, header.size);
+    put32(at + 24, header.link);
+    put32(at + 28, header.info);
+    put32(at + 32, header.align);
+    put32(at + 36, header.entsize);
+}
+
+} // namespace
+
+void ObjectWriter::build(std::span<const std::uint32_t> words, const SymbolTable* symbols) {
+    NF_STATS_PHASE(Emit);
+    _words = words;
+    if constexpr (std::endian::native != std::endian::little) {
+        _textBytes.resize(words.size() * 4);
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            put32(_textBytes.data() + i * 4, words[i]);
+        }
+    }
+
+    _buffer.clear();
+    _tailOffset = 0;
+    if (_format == Format::Elf) {
+        layoutElf(symbols);
+    }
+}
+
+void ObjectWriter::layoutElf(const SymbolTable* symbols) {
+    // Symbols: the null symbol, .text's section symbol, then every label
+    std::size_t symbolCount = 2;
+    std::size_t strtabSize = 1;
+    if (symbols) {
+        for (SymbolTable::SymbolId id = 0; id < symbols->size(); ++id) {
+            if (symbols->isDefined(id)) {
+                ++symbolCount;
+                strtabSize += symbols->name(id).size() + 1;
+            }
+        }
+    }
+
+    // File layout: header, .text, then the tail (.data is empty and sits
+    // where the tail starts)
+    std::size_t textOffset = kEhdrSize;
+    std::size_t textSize = _words.size() * 4;
+    std::size_t tailStart = textOffset + textSize;
+    std::size_t symtabOffset = tailStart;
+    std::size_t strtabOffset = symtabOffset + symbolCount * kSymSize;
+    std::size_t shstrtabOffset = strtabOffset + strtabSize;
+    std::size_t shdrOffset = (shstrtabOffset + kSectionNames.size() + 3) & ~std::size_t{3};
+    std::size_t fileSize = shdrOffset + SectionCount * kShdrSize;
+
+    // Everything but .text, in one allocation (reused across files)
+    _tailOffset = kEhdrSize;
+    _buffer.assign(fileSize - textSize, 0);
+    auto at = [&](std::size_t fileOffset) {
+        return _buffer.data() + (fileOffset < tailStart ? fileOffset : fileOffset - textSize);
+    };
+
+    // ELF header
+    char* ehdr = at(0);
+    std::memcpy(ehdr, "\x7f" "ELF", 4);
+    ehdr[4] = 1;    // ELFCLASS32
+    ehdr[5] = 1;    // ELFDATA2LSB
+    ehdr[6] = 1;    // EV_CURRENT
+    put16(ehdr + 16, kTypeRel);
+    put16(ehdr + 18, kMachineRiscv);
+    put32(ehdr + 20, 1);
+    put32(ehdr + 32, static_cast<std::uint32_t>(shdrOffset));
+    put16(ehdr + 40, static_cast<std::uint16_t>(kEhdrSize));
+    put16(ehdr + 46, static_cast<std::uint16_t>(kShdrSize));
+    put16(ehdr + 48, SectionCount);
+    put16(ehdr + 50, Shstrtab);
+
+    // .symtab and .strtab; all symbols are local
+    char* sym = at(symtabOffset) + kSymSize;
+    sym[12] = static_cast<char>(kSttSection);
+    put16(sym + 14, Text);
+    sym += kSymSize;
+    char* str = at(strtabOffset);
+    std::uint32_t nameOffset = 1;
+    if (symbols) {
+        for (SymbolTable::SymbolId id = 0; id < symbols->size(); ++id) {
+            if (!symbols->isDefined(id)) {
+                continue;
+            }
+            std::string_view name = symbols->name(id);
+            std::memcpy(str + nameOffset, name.data(), name.size());
+            put32(sym, nameOffset);
+            put32(sym + 4, symbols->address(id));
+            put16(sym + 14, Text);
+            nameOffset += static_cast<std::uint32_t>(name.size() + 1);
+            sym += kSymSize;
+        }
+    }
+    std::memcpy(at(shstrtabOffset), kSectionNames.data(), kSectionNames.size());
+
+    // Section headers (entry 0 stays all zero)
+    SectionHeader headers[SectionCount];
+    headers[Text] = {kShtProgbits, kShfAlloc | kShfExecinstr, static_cast<std::uint32_t>(textOffset),
+                     static_cast<std::uint32_t>(textSize), 0, 0, 4, 0};
+    headers[Data] = {kShtProgbits, kShfWrite | kShfAlloc, static_cast<std::uint32_t>(tailStart), 0, 0, 0, 4, 0};
+    headers[Symtab] = {kShtSymtab, 0, static_cast<std::uint32_t>(symtabOffset),
+                       static_cast<std::uint32_t>(symbolCount * kSymSize), Strtab,
+                       static_cast<std::uint32_t>(symbolCount), 4, kSymSize};
+    headers[Strtab] = {kShtStrtab, 0, static_cast<std::uint32_t>(strtabOffset),
+                       static_cast<std::uint32_t>(strtabSize), 0, 0, 1, 0};
+    headers[Shstrtab] = {kShtStrtab, 0, static_cast<std::uint32_t>(shstrtabOffset),
+                         static_cast<std::uint32_t>(kSectionNames.size()), 0, 0, 1, 0};
+    for (std::uint16_t s = Text; s < SectionCount; ++s) {
+        putSectionHeader(at(shdrOffset + s * kShdrSize), kSectionNameOffsets[s], headers[s]);
+    }
+}
+
+std::span<const char> ObjectWriter::head() const {
+    return std::span<const char>(_buffer.data(), _tailOffset);
+}
+
+std::span<const char> ObjectWriter::text() const {
+    if constexpr (std::endian::native == std::endian::little) {
+        return std::span<const char>(reinterpret_cast<const char*>(_words.data()), _words.size() * 4);
+    } else {
+        return std::span<const char>(_textBytes.data(), _textBytes.size());
+    }
+}
+
+std::span<const char> ObjectWriter::tail() const {
+    return std::span<const char>(_buffer.data() + _tailOffset, _buffer.size() - _tailOffset);
+}
+
+std::size_t ObjectWriter::size() const {
+    return _buffer.size() + _words.size() * 4;
+}
+
+std::vector<char> ObjectWriter::bytes() const {
+    std::vector<char> out;
+    out.reserve(size());
+    for (std::span<const char> part : {head(), text(), tail()}) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    return out;
+}
+
+bool ObjectWriter::write(const std::string& path) const {
+    NF_STATS_PHASE(Emit);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    iovec parts[3];
+    int count = 0;
+    for (std::span<const char> part : {head(), text(), tail()}) {
+        if (!part.empty()) {
+            parts[count++] = iovec{const_cast<char*>(part.data()), part.size()};
+        }
+    }
+
+    // One writev() normally does it all; loop only on a short write
+    iovec* next = parts;
+    while (count > 0) {
+        ssize_t written = ::writev(fd, next, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return false;
+        }
+        auto left = static_cast<std::size_t>(written);
+        NF_STATS_ADD(BytesWritten, left);
+        while (count > 0 && left >= next->iov_len) {
+            left -= next->iov_len;
+            ++next;
+            --count;
+        }
+        if (count > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + left;
+            next->iov_len -= left;
+        }
+    }
+    return ::close(fd) == 0;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "../include/PatternAutomaton.hpp"
+
+PatternAutomaton::PatternAutomaton()
+    : _next(kMaxClasses, dead),     // State 0: no operands seen
+      _classCount(FirstPunctuation)
+{
+    _punctuationClass.fill(noClass);
+}
+
+PatternAutomaton::StateId PatternAutomaton::step(StateId state, std::uint8_t tokenClass) {
+    StateId& edge = _next[state * kMaxClasses + tokenClass];
+    if (edge == dead) {
+        if (stateCount() >= dead) {
+            return dead;
+        }
+        edge = static_cast<StateId>(stateCount());
+        // 'edge' may dangle after this resize
+        _next.resize(_next.size() + kMaxClasses, dead);
+        return static_cast<StateId>(stateCount() - 1);
+    }
+    return edge;
+}
+
+bool PatternAutomaton::add(std::size_t id, std::span<const Token> pattern, bool takesLabels) {
+    if (pattern.size() > maxOperands) {
+        return false;
+    }
+
+    // Classes for any punctuation the pattern introduces
+    for (const Token& param : pattern) {
+        if (param.type != TokenType::PUNCTUATION) {
+            continue;
+        }
+        std::uint8_t& tokenClass = _punctuationClass[static_cast<std::uint8_t>(param.value)];
+        if (tokenClass == noClass) {
+            if (_classCount >= kMaxClasses) {
+                return false;
+            }
+            tokenClass = _classCount++;
+        }
+    }
+
+    StateId state = 0;
+    std::uint32_t labelSlots = 0;
+    for (std::size_t k = 0; k < pattern.size(); ++k) {
+        const Token& param = pattern[k];
+        std::uint8_t tokenClass = classOf(param);
+        if (tokenClass == noClass || tokenClass == Word) {
+            return false;       // Not a pattern token
+        }
+        StateId next = step(state, tokenClass);
+        if (next == dead) {
+            return false;
+        }
+        // A word in an immediate slot may name a label; it leads to the
+        // same state as an immediate, so the automaton stays deterministic
+        if (tokenClass == Immediate) {
+            _next[state * kMaxClasses + Word] = next;
+            labelSlots |= (takesLabels ? 1u : 0u) << k;
+        }
+        state = next;
+    }
+
+    if (id >= _accept.size()) {
+        _accept.resize(id + 1, dead);
+        _labelSlots.resize(id + 1, 0);
+    }
+    _accept[id] = state;
+    _labelSlots[id] = labelSlots;
+    return true;
+}
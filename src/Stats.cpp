@@ -0,0 +1,131 @@
+#include <ostream>
+
+#include "../include/Stats.hpp"
+
+namespace stats {
+
+const char* name(Phase phase) {
+    switch (phase) {
+        case Phase::SpecLoad: return "spec_load";
+        case Phase::Lex:      return "lex";
+        case Phase::Check:    return "check";
+        case Phase::Assemble: return "assemble";
+        case Phase::Encode:   return "encode";
+        case Phase::Emit:     return "emit";
+        default:              return "unknown";
+    }
+}
+
+const char* name(Counter counter) {
+    switch (counter) {
+        case Counter::Tokens:           return "tokens";
+        case Counter::Instructions:     return "instructions";
+        case Counter::SpecInstructions: return "spec_instructions";
+        case Counter::SyntaxNodes:      return "syntax_nodes";
+        case Counter::BytesRead:        return "bytes_read";
+        case Counter::BytesWritten:     return "bytes_written";
+        case Counter::Files:            return "files";
+        case Counter::Errors:           return "errors";
+        case Counter::Allocations:      return "allocations";
+        case Counter::AllocatedBytes:   return "allocated_bytes";
+        default:                        return "unknown";
+    }
+}
+
+#if NANOFORGE_STATS
+
+namespace {
+
+// Trivially constructible, so reading it from operator new needs no TLS
+// initialization
+thread_local ScopedPhase* currentPhase = nullptr;
+
+std::uint64_t nanoseconds(ScopedPhase::Clock::duration d) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+} // namespace
+
+ScopedPhase::ScopedPhase(Phase phase)
+    : _phase(phase),
+      _outer(currentPhase),
+      _elapsedNs(0)
+{
+    _resumed = Clock::now();
+    if (_outer) {
+        // Pause the enclosing phase while this one runs
+        _outer->_elapsedNs += nanoseconds(_resumed - _outer->_resumed);
+    }
+    currentPhase = this;
+    registry.phases[static_cast<std::size_t>(phase)].calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+ScopedPhase::~ScopedPhase() {
+    Clock::time_point now = Clock::now();
+    _elapsedNs += nanoseconds(now - _resumed);
+    registry.phases[static_cast<std::size_t>(_phase)].ns.fetch_add(_elapsedNs, std::memory_order_relaxed);
+    currentPhase = _outer;
+    if (_outer) {
+        _outer->_resumed = now;
+    }
+}
+
+const ScopedPhase* ScopedPhase::current() {
+    return currentPhase;
+}
+
+void reset() {
+    for (PhaseTotals& totals : registry.phases) {
+        totals.ns.store(0, std::memory_order_relaxed);
+        totals.calls.store(0, std::memory_order_relaxed);
+        totals.allocations.store(0, std::memory_order_relaxed);
+    }
+    for (CounterTotal& total : registry.counters) {
+        total.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void recordAllocation(std::size_t bytes) {
+    add(Counter::Allocations, 1);
+    add(Counter::AllocatedBytes, bytes);
+    if (const ScopedPhase* phase = currentPhase) {
+        registry.phases[static_cast<std::size_t>(phase->phase())].allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void writeJson(std::ostream& os, std::uint64_t wallNs) {
+    bool allocations = registry.allocationsTracked.load(std::memory_order_relaxed);
+
+    os << "{\n  \"enabled\": true,\n  \"wall_ns\": " << wallNs << ",\n  \"phases\": {";
+    for (std::size_t p = 0; p < static_cast<std::size_t>(Phase::Count); ++p) {
+        const PhaseTotals& totals = registry.phases[p];
+        os << (p ? "," : "") << "\n    \"" << name(static_cast<Phase>(p)) << "\": {"
+           << "\"ns\": " << totals.ns.load(std::memory_order_relaxed)
+           << ", \"calls\": " << totals.calls.load(std::memory_order_relaxed);
+        if (allocations) {
+            os << ", \"allocations\": " << totals.allocations.load(std::memory_order_relaxed);
+        }
+        os << "}";
+    }
+    os << "\n  },\n  \"counters\": {";
+    bool first = true;
+    for (std::size_t c = 0; c < static_cast<std::size_t>(Counter::Count); ++c) {
+        auto counter = static_cast<Counter>(c);
+        if (!allocations && (counter == Counter::Allocations || counter == Counter::AllocatedBytes)) {
+            continue;
+        }
+        os << (first ? "" : ",") << "\n    \"" << name(counter) << "\": " << value(counter);
+        first = false;
+    }
+    os << "\n  }\n}\n";
+}
+
+#else
+
+void writeJson(std::ostream& os, std::uint64_t wallNs) {
+    os << "{\n  \"enabled\": false,\n  \"wall_ns\": " << wallNs << "\n}\n";
+}
+
+#endif
+
+} // namespace stats
@@ -0,0 +1,71 @@
+// Global operator new/delete that count allocations for the stats report.
+// Linked into the riscv_compiler driver only; other binaries keep the
+// default allocator.
+#include "../include/Stats.hpp"
+
+#if NANOFORGE_STATS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Runs before main(); allocations during static initialization are counted
+// but attributed to no phase
+const bool trackingEnabled = [] {
+    stats::registry.allocationsTracked.store(true, std::memory_order_relaxed);
+    return true;
+}();
+
+void* allocate(std::size_t size) {
+    stats::recordAllocation(size);
+    // malloc(0) may return nullptr; new must not
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
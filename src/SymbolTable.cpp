@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <bit>
+
+#include "../include/RV32I.hpp"
+#include "../include/SymbolTable.hpp"
+
+SymbolTable::SymbolTable(std::size_t expectedSymbols) {
+    // Keep the table at most half full without rehashing
+    std::size_t capacity = std::bit_ceil(std::max<std::size_t>(16, expectedSymbols * 2));
+    _slots.assign(capacity, npos);
+    _hashes.reserve(expectedSymbols);
+    _nameOffsets.reserve(expectedSymbols);
+    _nameLengths.reserve(expectedSymbols);
+    _addresses.reserve(expectedSymbols);
+    _defined.reserve(expectedSymbols);
+}
+
+std::uint32_t SymbolTable::hashName(std::string_view name) {
+    return rv32i::hash(name, 0);
+}
+
+// Slot holding 'name', or the empty slot where it would go
+std::size_t SymbolTable::probe(std::string_view name, std::uint32_t hash) const {
+    std::size_t mask = _slots.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        SymbolId id = _slots[slot];
+        if (id == npos || (_hashes[id] == hash && this->name(id) == name)) {
+            return slot;
+        }
+    }
+}
+
+SymbolTable::SymbolId SymbolTable::intern(std::string_view name) {
+    std::uint32_t hash = hashName(name);
+    std::size_t slot = probe(name, hash);
+    if (_slots[slot] != npos) {
+        return _slots[slot];
+    }
+
+    SymbolId id = static_cast<SymbolId>(_hashes.size());
+    _hashes.push_back(hash);
+    _nameOffsets.push_back(static_cast<std::uint32_t>(_names.size()));
+    _nameLengths.push_back(static_cast<std::uint32_t>(name.size()));
+    _addresses.push_back(0);
+    _defined.push_back(0);
+    _names.append(name);
+    _slots[slot] = id;
+
+    if (_hashes.size() * 2 > _slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+SymbolTable::SymbolId SymbolTable::find(std::string_view name) const {
+    return _slots[probe(name, hashName(name))];
+}
+
+std::string_view SymbolTable::name(SymbolId id) const {
+    return std::string_view(_names.data() + _nameOffsets[id], _nameLengths[id]);
+}
+
+bool SymbolTable::define(SymbolId id, std::uint32_t address) {
+    if (_defined[id]) {
+        return false;
+    }
+    _defined[id] = 1;
+    _addresses[id] = address;
+    return true;
+}
+
+void SymbolTable::clear() {
+    std::fill(_slots.begin(), _slots.end(), npos);
+    _hashes.clear();
+    _nameOffsets.clear();
+    _nameLengths.clear();
+    _addresses.clear();
+    _defined.clear();
+    _names.clear();
+}
+
+void SymbolTable::grow() {
+    // Hashes are stored, so rehashing touches no name bytes
+    std::vector<SymbolId> slots(_slots.size() * 2, npos);
+    std::size_t mask = slots.size() - 1;
+    for (SymbolId id = 0; id < _hashes.size(); ++id) {
+        std::size_t slot = _hashes[id] & mask;
+        while (slots[slot] != npos) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+    _slots.swap(slots);
+}
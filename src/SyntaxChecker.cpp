@@ -1,123 +1,291 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iostream>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <memory>
-#include "../include/AST.h"
-#include "../include/TreeNode.hpp"
-#include "../include/SyntaxTree.hpp"
-#include "Reader.cpp" 
-
-// SyntaxChecker class
-class SyntaxChecker {
-private:
-    const std::unordered_map<std::string, std::vector<std::string>>& paramMap;
-
-public:
-    // Constructor with paramMap
-    SyntaxChecker(const std::unordered_map<std::string, std::vector<std::string>>& paramMap) : paramMap(paramMap) {}
-
-    bool checkInstruction(const std::string& instr) {
-        // Check if instruction exists in the paramMap
-        if (paramMap.find(instr) != paramMap.end()) {
-            return true;
+#include <span>
+#include "../include/Diagnostics.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/LookupKey.hpp"
+#include "../include/RV32I.hpp"
+#include "../include/Stats.hpp"
+#include "../include/SyntaxChecker.hpp"
+#include "../include/ThreadPool.hpp"
+
+SyntaxChecker::SyntaxChecker(const std::unordered_map<std::string, std::vector<Token>>& paramMap)
+    : paramMap(paramMap)
+{
+    // Built-in instruction tokens carry their mnemonic id; resolve them once
+    builtinPatterns.resize(rv32i::mnemonics.size(), nullptr);
+    for (size_t i = 0; i < rv32i::mnemonics.size(); ++i) {
+        auto it = paramMap.find(std::string(rv32i::mnemonics[i]));
+        if (it != paramMap.end()) {
+            builtinPatterns[i] = &it->second;
         }
+    }
+}
+
+bool SyntaxChecker::checkInstruction(const std::string& instr) {
+    // Check if instruction exists in the paramMap
+    if (paramMap.find(instr) != paramMap.end()) {
+        return true;
+    }
+    return false;
+}
+
+bool SyntaxChecker::checkSyntax(const AbstractTree<std::string>& tree) const {
+    Diagnostics diagnostics;
+    bool ok = checkSyntax(tree, diagnostics);
+    diagnostics.write(std::cerr);
+    return ok;
+}
+
+bool SyntaxChecker::checkSyntax(const FlatTree<std::string>& tree) const {
+    Diagnostics diagnostics;
+    bool ok = checkSyntax(tree, diagnostics);
+    diagnostics.write(std::cerr);
+    return ok;
+}
+
+bool SyntaxChecker::checkSyntax(Lexer& lexer) const {
+    Diagnostics diagnostics;
+    bool ok = checkSyntax(lexer, diagnostics);
+    diagnostics.write(std::cerr);
+    return ok;
+}
+
+bool SyntaxChecker::checkSyntax(const AbstractTree<std::string>& tree, Diagnostics& diagnostics) const {
+    NF_STATS_PHASE(Check);
+    size_t before = diagnostics.size();
+    // Check root
+    AbstractTreeNode<std::string>* root = tree.getRoot();
+    if (!root) {
+        diagnostics.report(DiagnosticCode::EmptyTree, 0, 0);
         return false;
     }
+    checkNode(root, diagnostics);
+    NF_STATS_ADD(Errors, diagnostics.size() - before);
+    return diagnostics.size() == before;
+}
 
-    // Check if the tree is syntactically correct
-    bool checkSyntax(const AbstractTree<std::string>& tree) const {
-        // Check root
-        AbstractTreeNode<std::string>* root = tree.getRoot();
-        if (!root) {
-            std::cerr << "Warning! The tree is empty (no root node).\n";
-            return false;
-        }
-        return checkNode(root);
+bool SyntaxChecker::checkSyntax(const AbstractTree<std::string>& tree, Diagnostics& diagnostics,
+                                ThreadPool& pool) const {
+    // Below this many subtrees per task, handing them out costs more than
+    // checking them
+    const size_t kMinChildren = 4 * 1024;
+
+    AbstractTreeNode<std::string>* root = tree.getRoot();
+    std::span<const std::unique_ptr<AbstractTreeNode<std::string>>> children;
+    if (root) {
+        children = root->getChildren();
+    }
+    // A few tasks per thread, so uneven subtrees balance out
+    size_t taskCount = std::min<size_t>(children.size() / kMinChildren, (pool.size() + 1) * 4);
+    if (taskCount < 2 || diagnostics.full()) {
+        return checkSyntax(tree, diagnostics);
     }
 
-private:
-    // Function to validate nodes
-    bool checkNode(AbstractTreeNode<std::string>* node) const {
-        // Base Case: If node is nullptr, return true
-        if (!node) {
-            return true;
-        }
+    NF_STATS_PHASE(Check);
+    size_t before = diagnostics.size();
+    NF_STATS_ADD(SyntaxNodes, 1);
+    checkValue(root, diagnostics);
+    if (diagnostics.full()) {
+        NF_STATS_ADD(Errors, diagnostics.size() - before);
+        return false;
+    }
 
-        // Get value of current node
-        std::string value = node->getValue();
+    // No task can contribute more than what is left under the cap
+    size_t remaining = diagnostics.maxErrors() == Diagnostics::unlimited
+                     ? Diagnostics::unlimited : diagnostics.maxErrors() - diagnostics.size();
+    std::vector<Diagnostics> found(taskCount, Diagnostics(remaining));
+    pool.parallelFor(taskCount, [&](size_t k) {
+        NF_STATS_PHASE(Check);
+        size_t end = children.size() * (k + 1) / taskCount;
+        for (size_t i = children.size() * k / taskCount; i < end && !found[k].full(); ++i) {
+            checkNode(children[i].get(), found[k]);
+        }
+    });
 
-        // Check Node
-        if (!isValidNode(value)) {
-            std::cerr << "Syntax Error: Invalid node value '" << value << "'.\n";
-            return false;
+    for (const Diagnostics& part : found) {
+        if (!diagnostics.append(part)) {
+            break;
         }
+    }
+    NF_STATS_ADD(Errors, diagnostics.size() - before);
+    return diagnostics.size() == before;
+}
+
+bool SyntaxChecker::checkSyntax(const FlatTree<std::string>& tree, Diagnostics& diagnostics) const {
+    NF_STATS_PHASE(Check);
+    if (tree.empty()) {
+        diagnostics.report(DiagnosticCode::EmptyTree, 0, 0);
+        return false;
+    }
+    size_t before = diagnostics.size();
+
+    // Expected child count per value id, -1 for unknown values
+    const auto& values = tree.values();
+    std::vector<long> expected(values.size());
+    for (size_t v = 0; v < values.size(); ++v) {
+        auto it = paramMap.find(values[v]);
+        expected[v] = (it == paramMap.end()) ? -1 : static_cast<long>(it->second.size());
+    }
 
-        // Check node children
-        const auto& children = node->getChildren();
-        if (!checkChildren(value, children)) {
-            return false;
+    NF_STATS_ADD(SyntaxNodes, tree.size());
+    for (FlatTree<std::string>::NodeId id = 0; id < tree.size() && !diagnostics.full(); ++id) {
+        long arity = expected[tree.valueId(id)];
+        size_t count = tree.childCount(id);
+        if (arity < 0) {
+            diagnostics.report(DiagnosticCode::InvalidNode, 0, 0, tree.value(id));
+        } else if (count != static_cast<size_t>(arity)) {
+            diagnostics.report(DiagnosticCode::ArityMismatch, 0, 0, tree.value(id), arity, count);
         }
+    }
+    NF_STATS_ADD(Errors, diagnostics.size() - before);
+    return diagnostics.size() == before;
+}
+
+bool SyntaxChecker::checkSyntax(Lexer& lexer, Diagnostics& diagnostics) const {
+    NF_STATS_PHASE(Check);
+    size_t before = diagnostics.size();
+    Token instruction(TokenType::ERROR);
+    const std::vector<Token>* pattern = nullptr;
+    bool haveInstruction = false;
+    bool skipLine = false;
+    size_t count = 0;                   // Operands seen on this line
+    size_t badOperand = 0;              // 1-based position of the first bad operand, 0 if none
+    Token mismatched(TokenType::ERROR);
 
-        // Iterate through all children
-        for (auto& child : children) {
-            if (!checkNode(child.get())) {
-                return false;
+    while (lexer.hasMoreTokens() && !diagnostics.full()) {
+        Token token = lexer.getNextToken();
+
+        if (token.type == TokenType::EoL || token.type == TokenType::EoF) {
+            if (haveInstruction) {
+                NF_STATS_ADD(SyntaxNodes, 1 + count);
+                std::string_view name = lexer.lexeme(instruction);
+                if (count != pattern->size()) {
+                    diagnostics.report(DiagnosticCode::ArityMismatch, instruction.line, lexer.column(instruction),
+                                       name, pattern->size(), count);
+                } else if (badOperand != 0) {
+                    diagnostics.report(DiagnosticCode::OperandKind, mismatched.line, lexer.column(mismatched),
+                                       badOperand, name, lexer.lexeme(mismatched));
+                }
+            }
+            haveInstruction = false;
+            skipLine = false;
+            count = 0;
+            badOperand = 0;
+            if (token.type == TokenType::EoF) {
+                break;
             }
+            continue;
+        }
+        if (skipLine) {
+            continue;
         }
-        return true;
-    }
 
-    // Helper function to check Node validity
-    bool isValidNode(const std::string& value) const {
-        return paramMap.find(value) != paramMap.end();
+        if (haveInstruction) {
+            // Kinds are compared as operands arrive; the count is settled at
+            // the end of the line
+            if (count < pattern->size() && badOperand == 0) {
+                const Token& expected = (*pattern)[count];
+                bool labelReference = expected.type == TokenType::IMMEDIATE
+                                   && token.type == TokenType::ERROR
+                                   && isLabelName(lexer.lexeme(token));
+                if (!labelReference && !expected.compareTokenType(token)) {
+                    badOperand = count + 1;
+                    mismatched = token;
+                }
+            }
+            ++count;
+        } else if (token.type == TokenType::INSTRUCTION) {
+            pattern = findPattern(lexer, token);
+            if (!pattern) {
+                diagnostics.report(DiagnosticCode::InvalidNode, token.line, lexer.column(token), lexer.lexeme(token));
+                skipLine = true;
+                continue;
+            }
+            instruction = token;
+            haveInstruction = true;
+        } else if (token.type != TokenType::LABEL) {
+            diagnostics.report(DiagnosticCode::ExpectedInstruction, token.line, lexer.column(token),
+                               lexer.lexeme(token));
+            skipLine = true;
+        }
     }
+    NF_STATS_ADD(Errors, diagnostics.size() - before);
+    return diagnostics.size() == before;
+}
 
-    // Check number of children nodes
-    bool checkChildren(const std::string& value, const std::vector<std::unique_ptr<AbstractTreeNode<std::string>>>& children) const {
-        const auto& expectedParams = paramMap.at(value); // Get expected parameters
-        if (children.size() != expectedParams.size()) {
-            std::cerr << "Syntax Error: Node '" << value << "' expects "
-                      << expectedParams.size() << " parameters, but has "
-                      << children.size() << ".\n";
-            return false;
-        }
-        return true;
+const std::vector<Token>* SyntaxChecker::findPattern(const Lexer& lexer, const Token& instruction) const {
+    std::string_view word = lexer.lexeme(instruction);
+    // Custom instruction sets leave value at 0, so confirm the spelling
+    if (instruction.value >= 0 && static_cast<size_t>(instruction.value) < builtinPatterns.size()
+        && rv32i::mnemonics[instruction.value] == word) {
+        return builtinPatterns[instruction.value];
     }
-};
+    auto it = paramMap.find(lookupKey(word));
+    return it == paramMap.end() ? nullptr : &it->second;
+}
 
-// Main
-int main() {
-    // Maps we want to fill
-    std::unordered_map<std::string, std::vector<std::string>> paramMap;
-    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+void SyntaxChecker::checkValue(const AbstractTreeNode<std::string>* node, Diagnostics& diagnostics) const {
+    // Get value of current node (by reference: checking must not allocate)
+    const std::string& value = node->getValue();
 
-    // Parse the instruction file to populate paramMap and binaryMap
-    if (!parseInstructionFile("instructions.txt", paramMap, binaryMap)) {
-        std::cerr << "Failed to parse instructions file.\n";
-        return 1;
+    // Check Node, then its children count; an invalid node has no expected count
+    if (!isValidNode(value)) {
+        diagnostics.report(DiagnosticCode::InvalidNode, 0, 0, value);
+    } else {
+        checkChildren(value, node->getChildren(), diagnostics);
     }
+}
 
-    // Create SyntaxChecker with paramMap
-    SyntaxChecker check(paramMap);
+void SyntaxChecker::checkNode(const AbstractTreeNode<std::string>* node, Diagnostics& diagnostics) const {
+    if (!node) {
+        return;
+    }
 
-    // Example: create a tree
-    SyntaxTree<std::string> tree;
-    
-    auto root = new TreeNode<std::string>("load");
-    auto child1 = new TreeNode<std::string>("register");
-    auto child2 = new TreeNode<std::string>("immediate");
+    // Preorder on an explicit stack, so deep trees cannot overflow the call
+    // stack. The stack starts in a local buffer and only goes to the heap
+    // for trees with hundreds of pending nodes, so checking small trees
+    // does not allocate.
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource scratch(buffer.data(), buffer.size());
+    std::pmr::vector<const AbstractTreeNode<std::string>*> pending(&scratch);
+    pending.reserve(buffer.size() / (2 * sizeof(void*)));
+    pending.push_back(node);
 
-    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(child1));
-    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(child2));
-    tree.setRoot(root);
+    // Stop once the error cap is reached
+    while (!pending.empty() && !diagnostics.full()) {
+        const AbstractTreeNode<std::string>* current = pending.back();
+        pending.pop_back();
+        NF_STATS_ADD(SyntaxNodes, 1);
+        checkValue(current, diagnostics);
 
-    // Create SyntaxChecker and check
-    if (check.checkSyntax(tree)) {
-        std::cout << "The tree is valid.\n";
-    } else {
-        std::cerr << "This tree is invalid due to syntax errors.\n";
+        // Children in reverse, so the first one is checked next
+        auto children = current->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            if (*it) {
+                pending.push_back(it->get());
+            }
+        }
     }
+}
+
+bool SyntaxChecker::isValidNode(const std::string& value) const {
+    return paramMap.find(value) != paramMap.end();
+}
 
-    return 0;
-}
\ No newline at end of file
+bool SyntaxChecker::checkChildren(const std::string& value, std::span<const std::unique_ptr<AbstractTreeNode<std::string>>> children,
+                                  Diagnostics& diagnostics) const {
+    const auto& expectedParams = paramMap.at(value); // Get expected parameters
+    if (children.size() != expectedParams.size()) {
+        diagnostics.report(DiagnosticCode::ArityMismatch, 0, 0, value, expectedParams.size(), children.size());
+        return false;
+    }
+    return true;
+}
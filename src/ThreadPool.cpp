@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "../include/ThreadPool.hpp"
+
+namespace {
+
+// Worker identity of the current thread, so submits from inside a task go
+// to the worker's own deque
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads)
+    : _pending(0),
+      _nextQueue(0),
+      _stopping(false)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _queues.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    _workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        _workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t index = (currentPool == this)
+                      ? currentIndex
+                      : _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    _pending.fetch_add(1);
+    {
+        // Pairs with the predicate check in workerLoop, so the wakeup is not lost
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wake.notify_one();
+}
+
+std::size_t ThreadPool::workerIndex() const {
+    return (currentPool == this) ? currentIndex : _workers.size();
+}
+
+bool ThreadPool::popLocal(std::size_t index, std::function<void()>& task) {
+    WorkerQueue& queue = *_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    // Newest first: its data is most likely still in cache
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    _pending.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, std::function<void()>& task) {
+    for (std::size_t k = 1; k < _queues.size(); ++k) {
+        WorkerQueue& victim = *_queues[(thief + k) % _queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            // Oldest first: the owner is working from the other end
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wake.wait(lock, [this] { return _stopping || _pending.load() > 0; });
+        if (_stopping && _pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Shared with helper tasks that may only start after we returned; they
+    // then find no index left and never touch 'body'.
+    struct LoopState {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+        std::size_t count = 0;
+        const std::function<void(std::size_t)>* body = nullptr;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<LoopState>();
+    state->count = count;
+    state->body = &body;
+
+    auto run = [](LoopState& s) {
+        std::size_t i;
+        while ((i = s.next.fetch_add(1)) < s.count) {
+            try {
+                (*s.body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (!s.error) {
+                    s.error = std::current_exception();
+                }
+            }
+            if (s.finished.fetch_add(1) + 1 == s.count) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.done.notify_all();
+            }
+        }
+    };
+
+    std::size_t helpers = std::min<std::size_t>(count - 1, _workers.size());
+    for (std::size_t h = 0; h < helpers; ++h) {
+        submit([state, run] { run(*state); });
+    }
+
+    // The caller takes part, so the loop finishes even if every worker is busy
+    run(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished.load() == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+void ThreadPool::parallelForRanges(std::size_t count, std::size_t minRange,
+                                   const std::function<void(std::size_t, std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    minRange = std::max<std::size_t>(minRange, 1);
+
+    // A few ranges per thread, so a slow range can be balanced by the others
+    std::size_t rangeCount = std::min<std::size_t>((_workers.size() + 1) * 4,
+                                                   (count + minRange - 1) / minRange);
+    if (rangeCount <= 1) {
+        body(0, count);
+        return;
+    }
+
+    parallelFor(rangeCount, [&](std::size_t r) {
+        body(count * r / rangeCount, count * (r + 1) / rangeCount);
+    });
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,207 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/BatchAssembler.hpp"
+#include "../include/CompiledSpec.hpp"
+#include "../include/Encoder.hpp"
+#include "../include/IncrementalAssembler.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/ObjectWriter.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ThreadPool.hpp"
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <input.s>...\n"
+              << "  -o <file>          Output file (single input only; default <input>.bin,\n"
+              << "                     or <input>.o with --format elf)\n"
+              << "  --format <fmt>     bin (raw instruction words, default) or elf\n"
+              << "                     (relocatable ELF32 RISC-V object)\n"
+              << "  --manifest <file>  Also assemble every path listed in <file>\n"
+              << "  --spec <file>      Load the instruction set from a spec file at run time\n"
+              << "                     (default: the RV32I tables built into the binary)\n"
+              << "  --incremental      Reuse the state cached in <output>.nfinc by the\n"
+              << "                     last run and re-assemble only the changed lines\n"
+              << "  -j <threads>       Worker threads (default: one per core)\n"
+              << "  --stats[=<file>]   Write phase timings and counters as JSON\n"
+              << "                     (to stdout, or to <file>)\n";
+}
+
+std::string defaultOutput(const std::string& input, const ObjectWriter& writer) {
+    return std::filesystem::path(input).replace_extension(writer.extension()).string();
+}
+
+// --incremental: start from the state cached next to the output and save
+// the new one; a missing or stale cache only means a full build
+void assembleIncremental(const Encoder& encoder, const std::string& input,
+                         const std::string& output, BatchResult& result) {
+    std::ostringstream diagnostics;
+    IncrementalAssembler assembler(encoder);
+    assembler.setDiagnostics(diagnostics);
+    std::string cache = IncrementalAssembler::cachePathFor(output);
+
+    result.input = input;
+    NF_STATS_ADD(Files, 1);
+    try {
+        MappedFile source(input);
+        assembler.load(cache);
+        result.ok = assembler.assemble(std::string_view(source.data(), source.size()));
+    } catch (const std::exception& e) {
+        diagnostics << e.what() << "\n";
+        result.ok = false;
+    }
+    if (result.ok) {
+        result.words = assembler.words();
+        assembler.exportSymbols(result.symbols);
+        if (!assembler.save(cache)) {
+            diagnostics << "Failed to write cache: " << cache << "\n";
+        }
+    }
+    result.diagnostics = diagnostics.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> inputs;
+    std::string outputPath;
+    std::string specPath;
+    ObjectWriter::Format format = ObjectWriter::Format::Binary;
+    unsigned threads = 0;
+    bool writeStats = false;
+    bool incremental = false;
+    std::string statsPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--manifest" && hasValue) {
+            if (!BatchAssembler::readManifest(argv[++i], inputs)) {
+                return 1;
+            }
+        } else if (arg == "--spec" && hasValue) {
+            specPath = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "elf") {
+                format = ObjectWriter::Format::Elf;
+            } else if (name != "bin") {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else if (arg == "-j" && hasValue) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--stats" || arg.rfind("--stats=", 0) == 0) {
+            writeStats = true;
+            statsPath = arg.size() > 8 ? arg.substr(8) : std::string();
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty() || (!outputPath.empty() && inputs.size() != 1)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // The instruction set is set up once and shared by every file. Unless
+    // --spec names a file, it comes from the tables compiled into the binary.
+    Encoder encoder;
+    if (specPath.empty()) {
+        encoder = Encoder::builtin();
+    } else {
+        try {
+            encoder = Encoder(CompiledSpec(specPath));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // The incremental state is lexed with the built-in RV32I vocabulary
+    if (incremental && !encoder.builtinMnemonicsOnly()) {
+        std::cerr << "--incremental needs an instruction set with only RV32I mnemonics\n";
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    std::vector<ObjectWriter> writers(pool.size() + 1, ObjectWriter(format));
+    auto outputFor = [&](const std::string& input) {
+        return outputPath.empty() ? defaultOutput(input, writers.front()) : outputPath;
+    };
+
+    std::vector<BatchResult> results;
+    if (incremental) {
+        results.resize(inputs.size());
+        pool.parallelFor(inputs.size(), [&](std::size_t i) {
+            assembleIncremental(encoder, inputs[i], outputFor(inputs[i]), results[i]);
+        });
+    } else {
+        BatchAssembler batch(encoder, pool);
+        results = batch.assemble(inputs);
+    }
+
+    // Outputs are written in parallel, one writer (and buffer) per thread;
+    // diagnostics are reported in input order
+    std::vector<char> written(results.size(), 0);
+    pool.parallelFor(results.size(), [&](std::size_t i) {
+        if (results[i].ok) {
+            ObjectWriter& writer = writers[pool.workerIndex()];
+            std::string path = outputFor(results[i].input);
+            writer.build(results[i].words, &results[i].symbols);
+            written[i] = writer.write(path);
+            if (!written[i]) {
+                results[i].diagnostics = "Failed to write output: " + path + " (" + std::strerror(errno) + ")\n";
+            }
+        }
+    });
+
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        std::istringstream diagnostics(results[i].diagnostics);
+        std::string line;
+        while (std::getline(diagnostics, line)) {
+            std::cerr << results[i].input << ": " << line << "\n";
+        }
+        failed += written[i] ? 0 : 1;
+    }
+    if (failed > 0 && results.size() > 1) {
+        std::cerr << failed << " of " << results.size() << " files failed\n";
+    }
+
+    if (writeStats) {
+        auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (statsPath.empty()) {
+            stats::writeJson(std::cout, static_cast<std::uint64_t>(wallNs));
+        } else {
+            std::ofstream out(statsPath, std::ios::trunc);
+            stats::writeJson(out, static_cast<std::uint64_t>(wallNs));
+            if (!out) {
+                std::cerr << "Failed to write stats: " << statsPath << "\n";
+                return 1;
+            }
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -1,4 +1,3 @@
-#pragma once
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -6,23 +5,18 @@
 #include <fstream>
 #include <sstream>
 #include <regex>
-#include <../include/Token.hpp>
-
-//--------------------------------------------------------------
-// Data structure for bit fields (unchanged)
-//--------------------------------------------------------------
-struct BitField {
-    int bitCount;      // e.g. 5
-    std::string field; // e.g. "00101" or "register1"
-};
+#include "../include/Reader.hpp"
+#include "../include/Stats.hpp"
 
 //--------------------------------------------------------------
 // Helper to convert something like "register : any" -> Token
 // Example inputs:
-//   "register : any"       => TokenType::REGISTER, lexeme="any"
-//   "punctuation : ,"      => TokenType::PUNCTUATION, lexeme=","
-//   "immediate : some_num" => TokenType::IMMEDIATE, lexeme="some_num"
+//   "register : any"       => TokenType::REGISTER
+//   "punctuation : ,"      => TokenType::PUNCTUATION, value=','
+//   "immediate : some_num" => TokenType::IMMEDIATE
 //   (etc.)
+// Pattern tokens carry no source text; punctuation keeps its character
+// in Token::value so it can be compared against lexed tokens.
 //--------------------------------------------------------------
 Token parseParamStringToToken(const std::string& paramString)
 {
@@ -37,7 +31,7 @@ Token parseParamStringToToken(const std::string& paramString)
     size_t colonPos = trimmed.find(':');
     if (colonPos == std::string::npos) {
         // If no colon found, treat the whole thing as an error or fallback
-        return Token(TokenType::ERROR, trimmed);
+        return Token(TokenType::ERROR);
     }
 
     // Left of colon => something like "register", "punctuation", etc.
@@ -69,7 +63,10 @@ Token parseParamStringToToken(const std::string& paramString)
     else if (typePart == "punctuation") ttype = TokenType::PUNCTUATION;
     // else, we keep it as ERROR or do something else
 
-    return Token(ttype, lexemePart);
+    if (ttype == TokenType::PUNCTUATION && !lexemePart.empty()) {
+        return Token(ttype, static_cast<unsigned char>(lexemePart[0]));
+    }
+    return Token(ttype);
 }
 
 //--------------------------------------------------------------
@@ -121,7 +118,7 @@ bool parseParamLine(
     // 4) We'll parse bracket tokens "[ ... ]" as single tokens; 
     //    everything else is whitespace-separated, which might be plain words
     //    or might be "foo : bar" style strings.
-    std::regex bracketRegex(R"(\[([^]]*)\])"); 
+    std::regex bracketRegex(R"(\[([^\]]*)\])"); 
     auto begin = std::sregex_iterator(remainder.begin(), remainder.end(), bracketRegex);
     auto endIt = std::sregex_iterator();
 
@@ -154,7 +151,7 @@ bool parseParamLine(
                 if (cpos == std::string::npos) {
                     // No colon => treat it as register or immediate? Up to you.
                     // We'll just say error for now.
-                    outTokens.push_back(Token(TokenType::ERROR, tokenChunk));
+                    outTokens.push_back(Token(TokenType::ERROR));
                 } else {
                     // parse as "xxxx : yyyy"
                     outTokens.push_back(parseParamStringToToken(tokenChunk));
@@ -181,7 +178,7 @@ bool parseParamLine(
         while (ss >> tokenChunk) {
             size_t cpos = tokenChunk.find(':');
             if (cpos == std::string::npos) {
-                outTokens.push_back(Token(TokenType::ERROR, tokenChunk));
+                outTokens.push_back(Token(TokenType::ERROR));
             } else {
                 outTokens.push_back(parseParamStringToToken(tokenChunk));
             }
@@ -198,7 +195,7 @@ bool parseBinaryLine(const std::string &line, std::vector<BitField> &outBitField
 {
     outBitFields.clear();
 
-    std::regex bracketRegex(R"(\[([^]]*)\])");
+    std::regex bracketRegex(R"(\[([^\]]*)\])");
     auto begin = std::sregex_iterator(line.begin(), line.end(), bracketRegex);
     auto endIt = std::sregex_iterator();
 
@@ -257,6 +254,7 @@ bool parseInstructionFile(
     std::unordered_map<std::string, std::vector<Token>> &paramMap,
     std::unordered_map<std::string, std::vector<BitField>> &binaryMap)
 {
+    NF_STATS_PHASE(SpecLoad);
     std::ifstream infile(filename);
     if (!infile.is_open()) {
         std::cerr << "Failed to open file: " << filename << "\n";
@@ -276,6 +274,7 @@ bool parseInstructionFile(
             break; // no more lines
         }
         lineCount++;
+        NF_STATS_ADD(BytesRead, line.size() + 1);
 
         bool okParam = parseParamLine(line, instrName, tokens);
         if (!okParam) {
@@ -291,6 +290,7 @@ bool parseInstructionFile(
             break;
         }
         lineCount++;
+        NF_STATS_ADD(BytesRead, line.size() + 1);
 
         bool okBits = parseBinaryLine(line, bits);
         if (!okBits) {
@@ -301,45 +301,8 @@ bool parseInstructionFile(
         // 3) Store into maps
         paramMap[instrName]  = tokens;
         binaryMap[instrName] = bits;
+        NF_STATS_ADD(SpecInstructions, 1);
     }
 
     return true;
 }
-
-//--------------------------------------------------------------
-// Demo main
-//--------------------------------------------------------------
-int main() {
-    // Now paramMap is: instructionName -> vector<Token>
-    std::unordered_map<std::string, std::vector<Token>> paramMap;
-    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
-
-    if (!parseInstructionFile("instructions.txt", paramMap, binaryMap)) {
-        std::cerr << "Failed to parse instructions file.\n";
-        return 1;
-    }
-
-    // Demonstration: print out paramMap
-    std::cout << "=== Param Map ===\n";
-    for (auto &kv : paramMap) {
-        const auto &instr  = kv.first;
-        const auto &tokens = kv.second;
-        std::cout << instr << " : \n";
-        for (auto &tok : tokens) {
-            std::cout << "   TokenType=" << static_cast<int>(tok.type)
-                      << ", lexeme='" << tok.lexeme << "'\n";
-        }
-        std::cout << "\n";
-    }
-
-    // Print out binaryMap
-    std::cout << "\n=== Binary Map ===\n";
-    for (auto &kv : binaryMap) {
-        std::cout << kv.first << " : \n";
-        for (auto &bf : kv.second) {
-            std::cout << "   - " << bf.bitCount << " : " << bf.field << "\n";
-        }
-    }
-
-    return 0;
-}
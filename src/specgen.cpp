@@ -0,0 +1,195 @@
+// nanoforge_specgen: turn instructions.txt into ISATables.hpp, a header of
+// constexpr operand patterns, bit-field layouts and dense opcode ids.
+//
+//   nanoforge_specgen <instructions.txt> <ISATables.hpp>
+//
+// The output is only rewritten when its contents change, so spec edits that
+// do not change the tables (e.g. reordering) do not rebuild its users.
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../include/ISA.hpp"
+#include "../include/Reader.hpp"
+
+namespace {
+
+const char* tokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::INSTRUCTION: return "TokenType::INSTRUCTION";
+        case TokenType::REGISTER:    return "TokenType::REGISTER";
+        case TokenType::IMMEDIATE:   return "TokenType::IMMEDIATE";
+        case TokenType::LABEL:       return "TokenType::LABEL";
+        case TokenType::PUNCTUATION: return "TokenType::PUNCTUATION";
+        case TokenType::EoL:         return "TokenType::EoL";
+        case TokenType::EoF:         return "TokenType::EoF";
+        case TokenType::ERROR:       return "TokenType::ERROR";
+    }
+    return "TokenType::ERROR";
+}
+
+const char* fieldKindName(isa::FieldKind kind) {
+    switch (kind) {
+        case isa::FieldKind::Constant:  return "FieldKind::Constant";
+        case isa::FieldKind::Register:  return "FieldKind::Register";
+        case isa::FieldKind::Immediate: return "FieldKind::Immediate";
+    }
+    return "FieldKind::Constant";
+}
+
+std::string charLiteral(int c) {
+    if (c == 0) return "0";
+    if (c == '\'' || c == '\\') return std::string("'\\") + static_cast<char>(c) + "'";
+    if (std::isprint(c)) return std::string("'") + static_cast<char>(c) + "'";
+    return std::to_string(c);
+}
+
+// Opcode enumerator for a mnemonic: upper case, non-identifier chars as '_'
+std::string enumName(const std::string& name) {
+    std::string out;
+    for (char c : name) {
+        out += std::isalnum(static_cast<unsigned char>(c))
+             ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : '_';
+    }
+    if (out.empty() || std::isdigit(static_cast<unsigned char>(out[0]))) {
+        out.insert(out.begin(), '_');
+    }
+    return out;
+}
+
+bool generate(const std::string& specPath, std::string& out) {
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+    if (!parseInstructionFile(specPath, paramMap, binaryMap)) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (const auto& kv : paramMap) {
+        names.push_back(kv.first);
+    }
+    std::sort(names.begin(), names.end());
+
+    std::ostringstream enums, operands, fields, infos;
+    std::size_t operandCount = 0, fieldCount = 0;
+
+    for (const std::string& name : names) {
+        const auto& pattern = paramMap[name];
+        const auto& bits = binaryMap[name];
+
+        int totalBits = 0;
+        std::size_t firstField = fieldCount;
+        for (const BitField& bf : bits) {
+            isa::FieldLayout layout;
+            if (!isa::resolveField(bf.field, bf.bitCount, pattern, layout)) {
+                std::cerr << specPath << ": instruction '" << name
+                          << "' has an invalid bit field '" << bf.field << "'\n";
+                return false;
+            }
+            totalBits += bf.bitCount;
+            fields << "    {" << static_cast<int>(layout.bitCount) << ", " << fieldKindName(layout.kind)
+                   << ", " << static_cast<int>(layout.operand) << ", " << static_cast<int>(layout.hi)
+                   << ", " << static_cast<int>(layout.lo) << ", " << layout.constant << "u},"
+                   << "  // " << name << ": " << bf.field << "\n";
+            ++fieldCount;
+        }
+        if (totalBits != 32) {
+            std::cerr << specPath << ": instruction '" << name << "' encodes "
+                      << totalBits << " bits instead of 32\n";
+            return false;
+        }
+
+        std::size_t firstOperand = operandCount;
+        for (const Token& t : pattern) {
+            operands << "    {" << tokenTypeName(t.type) << ", "
+                     << charLiteral(t.type == TokenType::PUNCTUATION ? t.value : 0) << "},"
+                     << "  // " << name << "\n";
+            ++operandCount;
+        }
+
+        enums << "    " << enumName(name) << ",\n";
+        infos << "    {\"" << name << "\", " << firstOperand << ", " << pattern.size()
+              << ", " << firstField << ", " << bits.size() << "},\n";
+    }
+
+    std::ostringstream os;
+    os << "// Generated by nanoforge_specgen from instructions.txt. Do not edit.\n"
+       << "#pragma once\n\n"
+       << "#include <array>\n"
+       << "#include <cstddef>\n"
+       << "#include <cstdint>\n"
+       << "#include <span>\n"
+       << "#include <string_view>\n"
+       << "#include \"ISA.hpp\"\n"
+       << "#include \"RV32I.hpp\"\n\n"
+       << "namespace isa {\n\n"
+       << "inline constexpr std::size_t kInstructionCount = " << names.size() << ";\n"
+       << "inline constexpr std::size_t npos = SIZE_MAX;\n\n"
+       << "// Dense opcode ids, in name order\n"
+       << "enum class Opcode : std::uint16_t {\n" << enums.str() << "};\n\n"
+       << "inline constexpr std::array<OperandPattern, " << operandCount << "> operands = {{\n"
+       << operands.str() << "}};\n\n"
+       << "inline constexpr std::array<FieldLayout, " << fieldCount << "> fields = {{\n"
+       << fields.str() << "}};\n\n"
+       << "inline constexpr std::array<InstructionInfo, kInstructionCount> instructions = {{\n"
+       << infos.str() << "}};\n\n"
+       << "constexpr std::span<const OperandPattern> operandsOf(Opcode op) {\n"
+       << "    const InstructionInfo& info = instructions[static_cast<std::size_t>(op)];\n"
+       << "    return std::span<const OperandPattern>(operands.data() + info.firstOperand, info.operandCount);\n"
+       << "}\n\n"
+       << "constexpr std::span<const FieldLayout> fieldsOf(Opcode op) {\n"
+       << "    const InstructionInfo& info = instructions[static_cast<std::size_t>(op)];\n"
+       << "    return std::span<const FieldLayout>(fields.data() + info.firstField, info.fieldCount);\n"
+       << "}\n\n"
+       << "// Opcode id of a mnemonic, or npos. Binary search over the sorted names.\n"
+       << "constexpr std::size_t find(std::string_view name) {\n"
+       << "    std::size_t lo = 0, hi = instructions.size();\n"
+       << "    while (lo < hi) {\n"
+       << "        std::size_t mid = lo + (hi - lo) / 2;\n"
+       << "        if (instructions[mid].name == name) return mid;\n"
+       << "        if (instructions[mid].name < name) lo = mid + 1; else hi = mid;\n"
+       << "    }\n"
+       << "    return npos;\n"
+       << "}\n\n"
+       << "// Opcode id per built-in mnemonic id (Token::value of lexed instructions)\n"
+       << "inline constexpr std::array<std::size_t, rv32i::mnemonics.size()> fromMnemonic = [] {\n"
+       << "    std::array<std::size_t, rv32i::mnemonics.size()> out{};\n"
+       << "    for (std::size_t i = 0; i < out.size(); ++i) {\n"
+       << "        out[i] = find(rv32i::mnemonics[i]);\n"
+       << "    }\n"
+       << "    return out;\n"
+       << "}();\n\n"
+       << "} // namespace isa\n";
+    out = os.str();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <instructions.txt> <output header>\n";
+        return 1;
+    }
+
+    std::string header;
+    if (!generate(argv[1], header)) {
+        std::cerr << "Failed to generate ISA tables from " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Always written; the build copies it over the real header only if it
+    // changed (copy_if_different), so users of an identical header are not
+    // rebuilt
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+    out << header;
+    return out ? 0 : 1;
+}
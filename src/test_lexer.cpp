@@ -61,7 +61,7 @@ int main() {
             Token token = std::move(tokenDeque.front());
             tokenDeque.pop_front();
 
-            std::cout << "Consumed Token: \"" << token.lexeme << "\", Type: ";
+            std::cout << "Consumed Token: \"" << lexer.lexeme(token) << "\", Type: ";
             switch (token.type) {
                 case TokenType::INSTRUCTION:   std::cout << "INSTRUCTION";   break;
                 case TokenType::REGISTER:      std::cout << "REGISTER";      break;
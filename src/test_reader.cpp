@@ -0,0 +1,43 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../include/Reader.hpp"
+
+//--------------------------------------------------------------
+// Demo main
+//--------------------------------------------------------------
+int main() {
+    // Now paramMap is: instructionName -> vector<Token>
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+
+    if (!parseInstructionFile("instructions.txt", paramMap, binaryMap)) {
+        std::cerr << "Failed to parse instructions file.\n";
+        return 1;
+    }
+
+    // Demonstration: print out paramMap
+    std::cout << "=== Param Map ===\n";
+    for (auto &kv : paramMap) {
+        const auto &instr  = kv.first;
+        const auto &tokens = kv.second;
+        std::cout << instr << " : \n";
+        for (auto &tok : tokens) {
+            std::cout << "   TokenType=" << static_cast<int>(tok.type)
+                      << ", value=" << tok.value << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    // Print out binaryMap
+    std::cout << "\n=== Binary Map ===\n";
+    for (auto &kv : binaryMap) {
+        std::cout << kv.first << " : \n";
+        for (auto &bf : kv.second) {
+            std::cout << "   - " << bf.bitCount << " : " << bf.field << "\n";
+        }
+    }
+
+    return 0;
+}
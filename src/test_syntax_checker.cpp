@@ -0,0 +1,45 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../include/Reader.hpp"
+#include "../include/SyntaxChecker.hpp"
+#include "../include/SyntaxTree.hpp"
+#include "../include/TreeNode.hpp"
+
+// Main
+int main() {
+    // Maps we want to fill
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+
+    // Parse the instruction file to populate paramMap and binaryMap
+    if (!parseInstructionFile("instructions.txt", paramMap, binaryMap)) {
+        std::cerr << "Failed to parse instructions file.\n";
+        return 1;
+    }
+
+    // Create SyntaxChecker with paramMap
+    SyntaxChecker check(paramMap);
+
+    // Example: create a tree
+    SyntaxTree<std::string> tree;
+    
+    auto root = new TreeNode<std::string>("load");
+    auto child1 = new TreeNode<std::string>("register");
+    auto child2 = new TreeNode<std::string>("immediate");
+
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(child1));
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(child2));
+    tree.setRoot(root);
+
+    // Create SyntaxChecker and check
+    if (check.checkSyntax(tree)) {
+        std::cout << "The tree is valid.\n";
+    } else {
+        std::cerr << "This tree is invalid due to syntax errors.\n";
+    }
+
+    return 0;
+}
\ No newline at end of file
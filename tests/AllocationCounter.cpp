@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+namespace {
+
+// Trivially constructible, so operator new can use them at any time
+thread_local std::size_t threadAllocations = 0;
+thread_local std::size_t threadBytes = 0;
+
+void* allocate(std::size_t size) {
+    ++threadAllocations;
+    threadBytes += size;
+    // malloc(0) may return nullptr; new must not
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+std::size_t AllocationCounter::allocations() const {
+    return threadAllocations - _startAllocations;
+}
+
+std::size_t AllocationCounter::bytes() const {
+    return threadBytes - _startBytes;
+}
+
+void AllocationCounter::reset() {
+    _startAllocations = threadAllocations;
+    _startBytes = threadBytes;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// Test-only allocation tracking. AllocationCounter.cpp replaces the global
+// operator new/delete of the riscv_compiler_tests binary and counts every
+// allocation per thread, so a test can assert an allocation budget for the
+// code it runs without noise from other threads:
+//
+//     AllocationCounter counter;
+//     checker.checkSyntax(tree);
+//     std::size_t made = counter.allocations();   // read before EXPECT_*
+//     EXPECT_EQ(made, 0u);
+//
+// Only the calling thread is counted. Work handed to a thread pool is not.
+class AllocationCounter {
+public:
+    AllocationCounter() { reset(); }
+
+    // Allocations (and bytes requested) by this thread since construction
+    // or the last reset()
+    std::size_t allocations() const;
+    std::size_t bytes() const;
+
+    void reset();
+
+private:
+    std::size_t _startAllocations;
+    std::size_t _startBytes;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Encoder.hpp"
+#include "../include/Reader.hpp"
+
+// The instruction spec the tests run against (NANOFORGE_SPEC_PATH), parsed
+// once per test binary on first use and shared by every suite:
+//
+//     Assembler assembler(testSpec().encoder);
+//     SyntaxChecker checker(testSpec().paramMap);
+struct TestSpec {
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+    Encoder encoder;
+};
+
+inline const TestSpec& testSpec() {
+    static const TestSpec spec = [] {
+        TestSpec parsed;
+        if (!parseInstructionFile(NANOFORGE_SPEC_PATH, parsed.paramMap, parsed.binaryMap)) {
+            ADD_FAILURE() << "Cannot parse the instruction spec " << NANOFORGE_SPEC_PATH;
+        }
+        parsed.encoder = Encoder(parsed.paramMap, parsed.binaryMap);
+        return parsed;
+    }();
+    return spec;
+}
@@ -0,0 +1,128 @@
+#include "../include/ASTFactory.hpp"
+#include "../include/Encoder.hpp"
+#include "../include/FlatTree.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/SyntaxChecker.hpp"
+#include "AllocationCounter.hpp"
+#include "TestSpec.hpp"
+#include <gtest/gtest.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// The token deque allocates one block per 512 bytes (32 tokens), plus a
+// few map reallocations; lexing itself must add nothing per token
+std::size_t tokenBudget(std::size_t tokens) {
+    return tokens / 32 + 16;
+}
+
+std::string repeatLines(const std::string& line, std::size_t count) {
+    std::string source;
+    for (std::size_t i = 0; i < count; ++i) {
+        source += line;
+    }
+    return source;
+}
+
+} // namespace
+
+TEST(AllocationTest, CounterSeesOwnAllocations) {
+    AllocationCounter counter;
+    auto block = std::make_unique<char[]>(100);
+    std::size_t made = counter.allocations();
+    std::size_t bytes = counter.bytes();
+    EXPECT_EQ(made, 1u);
+    EXPECT_GE(bytes, 100u);
+}
+
+TEST(AllocationTest, BuiltinLexingStaysWithinBudget) {
+    const std::string source = repeatLines("loop: addi a0, a0, 0x7ff\nbeq a0, zero, loop\n", 2000);
+    std::deque<Token> tokens;
+
+    AllocationCounter counter;
+    Lexer lexer(source, tokens);
+    std::size_t made = counter.allocations();
+    EXPECT_LE(made, tokenBudget(tokens.size()));
+}
+
+TEST(AllocationTest, CustomSetLexingDoesNotCopyWords) {
+    // Words longer than the small-string buffer would allocate if copied
+    std::unordered_set<std::string> instructions = {"load_effective_address_long"};
+    std::unordered_set<std::string> punctuation = {"(", ")"};
+    const std::string source = repeatLines("load_effective_address_long register_operand_one ( x1 )\n", 2000);
+    std::deque<Token> tokens;
+
+    AllocationCounter counter;
+    Lexer lexer(source, tokens, instructions, punctuation);
+    std::size_t made = counter.allocations();
+    EXPECT_LE(made, tokenBudget(tokens.size()));
+    EXPECT_EQ(tokens.front().type, TokenType::INSTRUCTION);
+}
+
+TEST(AllocationTest, CheckSyntaxAllocatesNothing) {
+    // Long values: a copy of any of them would show up as an allocation
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    paramMap["load_word_instruction"] = {Token(TokenType::REGISTER), Token(TokenType::IMMEDIATE)};
+    paramMap["register_operand_node"];
+    paramMap["immediate_operand_node"];
+
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    auto* root = ASTFactory<std::string>::createNode("load_word_instruction");
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(
+        ASTFactory<std::string>::createNode("register_operand_node")));
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(
+        ASTFactory<std::string>::createNode("immediate_operand_node")));
+    tree->setRoot(root);
+    FlatTree<std::string> flat = flatten(*tree);
+
+    SyntaxChecker checker(paramMap);
+    AllocationCounter counter;
+    bool ok = checker.checkSyntax(*tree);
+    std::size_t made = counter.allocations();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(made, 0u);
+
+    // The flat walk builds its arity table once per call
+    counter.reset();
+    ok = checker.checkSyntax(flat);
+    made = counter.allocations();
+    EXPECT_TRUE(ok);
+    EXPECT_LE(made, 1u);
+}
+
+TEST(AllocationTest, StreamingCheckAllocatesNothing) {
+    SyntaxChecker checker(testSpec().paramMap);
+
+    std::string source;
+    for (int i = 0; i < 500; ++i) {
+        source += "loop" + std::to_string(i) + ": addi x1, x1, 1\nlw x2, 8(x1)\nbne x1, x2, loop0\n";
+    }
+    std::deque<Token> tokens;
+    Lexer lexer(source, tokens);
+
+    // No tree, no operand buffer: the check itself never allocates
+    AllocationCounter counter;
+    bool ok = checker.checkSyntax(lexer);
+    std::size_t made = counter.allocations();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(made, 0u);
+}
+
+TEST(AllocationTest, EncodingAllocatesNothing) {
+    const Encoder& encoder = testSpec().encoder;
+    std::vector<Token> operands = {Token(TokenType::REGISTER, 7), Token(TokenType::IMMEDIATE, 20),
+                                   Token(TokenType::PUNCTUATION, '('), Token(TokenType::REGISTER, 9),
+                                   Token(TokenType::PUNCTUATION, ')')};
+
+    AllocationCounter counter;
+    std::size_t id = encoder.find("lw");
+    std::uint32_t word = encoder.encode(id, operands);
+    std::size_t made = counter.allocations();
+    EXPECT_EQ(word, 0x0144A383u);   // lw x7, 20(x9)
+    EXPECT_EQ(made, 0u);
+}
@@ -0,0 +1,186 @@
+#include "../include/Assembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/ThreadPool.hpp"
+#include "TestSpec.hpp"
+#include <gtest/gtest.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace {
+
+class AssemblerTest : public ::testing::Test {
+protected:
+    bool assemble(std::string_view source, Assembler& assembler) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens);
+        return assembler.assemble(lexer);
+    }
+
+    static const Encoder& encoder() { return testSpec().encoder; }
+};
+
+} // namespace
+
+TEST_F(AssemblerTest, ResolvesBackwardAndForwardLabels) {
+    const std::string source =
+        "start:\n"
+        "addi x1, x0, 10\n"
+        "loop: addi x1, x1, 0xFFF\n"
+        "bne x1, x0, loop\n"
+        "beq x0, x0, end\n"
+        "add x2, x2, x2\n"
+        "end: jal x0, start\n";
+
+    Assembler assembler(encoder());
+    ASSERT_TRUE(assemble(source, assembler));
+    ASSERT_EQ(assembler.instructions().size(), 6u);
+    EXPECT_EQ(assembler.symbols().size(), 3u);
+    EXPECT_EQ(assembler.symbols().address(assembler.symbols().find("end")), 20u);
+
+    // Label operands become PC-relative immediates
+    const auto& ops = assembler.operands();
+    EXPECT_EQ(ops[assembler.instructions()[2].firstOperand + 2].value, -4);    // loop, backward
+    EXPECT_EQ(ops[assembler.instructions()[3].firstOperand + 2].value, 8);     // end, forward
+    EXPECT_EQ(ops[assembler.instructions()[5].firstOperand + 1].value, -20);   // start
+
+    std::vector<std::uint32_t> words;
+    assembler.encode(words);
+    ASSERT_EQ(words.size(), 6u);
+    EXPECT_EQ(words[0], 0x00A00093u);   // addi x1, x0, 10
+    EXPECT_EQ(words[1], 0xFFF08093u);   // addi x1, x1, -1
+    EXPECT_EQ(words[2], 0xFE009EE3u);   // bne x1, x0, -4
+    EXPECT_EQ(words[3], 0x00000463u);   // beq x0, x0, 8
+    EXPECT_EQ(words[4], 0x00210133u);   // add x2, x2, x2
+    EXPECT_EQ(words[5], 0xFEDFF06Fu);   // jal x0, -20
+}
+
+TEST_F(AssemblerTest, ReportsEveryError) {
+    const std::string source =
+        "addi x1, x0\n"                 // Missing operand
+        "beq x1, x2, nowhere\n"         // Undefined label
+        "here: add x1, x2, x3\n"
+        "here: add x1, x2, x3\n"        // Duplicate label
+        "addi x1, x0, 5000\n"           // Out of range
+        "x1, x2\n";                     // No instruction
+    Assembler assembler(encoder());
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(assemble(source, assembler));
+    std::string messages = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(assembler.errorCount(), 5u);
+    EXPECT_NE(messages.find("Undefined label 'nowhere'"), std::string::npos);
+    EXPECT_NE(messages.find("(line 2, column 13)"), std::string::npos);
+}
+
+TEST_F(AssemblerTest, ReportsUndefinedLabelsInLineOrder) {
+    const std::string source =
+        "beq x0, x0, second\n"
+        "beq x0, x0, first\n"
+        "jal x0, second\n"
+        "jal x0, first\n";
+    Assembler assembler(encoder());
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(assemble(source, assembler));
+    EXPECT_EQ(testing::internal::GetCapturedStderr(),
+              "Assembly Error (line 1, column 13): Undefined label 'second'\n"
+              "Assembly Error (line 2, column 13): Undefined label 'first'\n"
+              "Assembly Error (line 3, column 9): Undefined label 'second'\n"
+              "Assembly Error (line 4, column 9): Undefined label 'first'\n");
+}
+
+TEST_F(AssemblerTest, ManyForwardLabels) {
+    // Every label is referenced before it is defined
+    const int count = 100000;
+    std::string source;
+    for (int i = 0; i < count; ++i) {
+        source += "jal x1, L" + std::to_string(i) + "\n";
+    }
+    for (int i = 0; i < count; ++i) {
+        source += "L" + std::to_string(i) + ": add x1, x1, x1\n";
+    }
+
+    Assembler assembler(encoder());
+    ASSERT_TRUE(assemble(source, assembler));
+    EXPECT_EQ(assembler.symbols().size(), static_cast<std::size_t>(count));
+    const auto& ops = assembler.operands();
+    for (int i = 0; i < count; i += 9973) {
+        // jal i at 4*i, label i at 4*(count + i)
+        EXPECT_EQ(ops[assembler.instructions()[i].firstOperand + 1].value, 4 * count);
+    }
+
+    // Reuse keeps capacity and starts clean
+    assembler.reset();
+    EXPECT_EQ(assembler.symbols().size(), 0u);
+    ASSERT_TRUE(assemble("a: jal x0, a\n", assembler));
+    EXPECT_EQ(assembler.operands()[1].value, 0);
+}
+
+TEST_F(AssemblerTest, RejectsImmediatesBeyond32Bits) {
+    for (const char* source : {"addi x1, x2, 4294967297\n", "addi x1, x2, 99999999999\n",
+                               "lui x1, 0x100000001\n"}) {
+        Assembler assembler(encoder());
+        testing::internal::CaptureStderr();
+        EXPECT_FALSE(assemble(source, assembler)) << source;
+        std::string messages = testing::internal::GetCapturedStderr();
+        EXPECT_NE(messages.find("should be an immediate,"), std::string::npos) << messages;
+    }
+}
+
+TEST_F(AssemblerTest, AcceptsLabelsOnlyAsBranchAndJumpTargets) {
+    // Labels resolve PC-relative, which only branches and jumps expect
+    const std::string source =
+        "start: addi x1, x0, 1\n"
+        "lui x2, start\n"
+        "addi x3, x0, start\n"
+        "lw x4, start(x0)\n"
+        "jalr x0, start(x1)\n"
+        "beq x0, x0, start\n"
+        "jal x0, start\n";
+    Assembler assembler(encoder());
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(assemble(source, assembler));
+    std::string messages = testing::internal::GetCapturedStderr();
+    EXPECT_NE(messages.find("(line 2, column 9): Operand 2 of 'lui' names label 'start', label not allowed here"),
+              std::string::npos) << messages;
+    for (const char* line : {"(line 3, column 14)", "(line 4, column 8)", "(line 5, column 10)"}) {
+        EXPECT_NE(messages.find(line), std::string::npos) << line << "\n" << messages;
+    }
+    EXPECT_EQ(messages.find("line 6"), std::string::npos) << messages;
+    EXPECT_EQ(messages.find("line 7"), std::string::npos) << messages;
+    EXPECT_EQ(assembler.errorCount(), 4u);
+}
+
+TEST_F(AssemblerTest, EncodesNegativeImmediates) {
+    Assembler assembler(encoder());
+    ASSERT_TRUE(assemble("addi x1, x2, -4\n"
+                         "addi x1, x2, -2048\n"
+                         "sw x2, -8(x3)\n", assembler));
+    std::vector<std::uint32_t> words;
+    assembler.encode(words);
+    ASSERT_EQ(words.size(), 3u);
+    EXPECT_EQ(words[0], 0xFFC10093u);   // addi x1, x2, -4
+    EXPECT_EQ(words[1], 0x80010093u);   // addi x1, x2, -2048
+    EXPECT_EQ(words[2], 0xFE21AC23u);   // sw x2, -8(x3)
+
+    // Out of range once negative, and a '-' that is not part of a number
+    for (const char* source : {"addi x1, x2, -2049\n", "addi x1, x2, - 4\n"}) {
+        Assembler rejecting(encoder());
+        testing::internal::CaptureStderr();
+        EXPECT_FALSE(assemble(source, rejecting)) << source;
+        testing::internal::GetCapturedStderr();
+    }
+}
+
+TEST_F(AssemblerTest, RejectsLabelNamesWithUnderscores) {
+    const std::string source =
+        "end_label: addi x1, x1, 1\n"
+        "jal x0, end_label\n";
+    Assembler assembler(encoder());
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(assemble(source, assembler));
+    std::string messages = testing::internal::GetCapturedStderr();
+    EXPECT_NE(messages.find("(line 1, column 1): Invalid label 'end_label:'"), std::string::npos) << messages;
+    EXPECT_NE(messages.find("(line 2, column 9): Operand 2 of 'jal' is not a valid label name"),
+              std::string::npos) << messages;
+    EXPECT_EQ(messages.find("Undefined label"), std::string::npos) << messages;
+}
@@ -0,0 +1,170 @@
+#include "../include/ASTFactory.hpp"
+#include "../include/FlatTree.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// Build load(register, immediate) under 'root' using the given node factory
+template <typename MakeNode>
+void buildLoad(AbstractTree<std::string>& tree, MakeNode makeNode) {
+    auto* root = makeNode("load");
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(makeNode("register")));
+    root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(makeNode("immediate")));
+    tree.setRoot(root);
+}
+
+TEST(ASTFactoryTest, HeapTreeBuildAndClear) {
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    buildLoad(*tree, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+
+    std::ostringstream out;
+    tree->traverse(out);
+    EXPECT_EQ(out.str(), "load register immediate \n");
+
+    tree->clear();
+    EXPECT_EQ(tree->getRoot(), nullptr);
+}
+
+TEST(ASTFactoryTest, ArenaTreeReusesBlocks) {
+    Arena arena;
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree(arena));
+
+    for (int round = 0; round < 3; ++round) {
+        buildLoad(*tree, [&](const std::string& v) { return ASTFactory<std::string>::createNode(arena, v); });
+
+        std::ostringstream out;
+        tree->traverse(out);
+        EXPECT_EQ(out.str(), "load register immediate \n");
+        EXPECT_EQ(tree->getRoot()->getChildren().size(), 2u);
+
+        tree->clear();
+        EXPECT_EQ(tree->getRoot(), nullptr);
+        // Clearing rewinds the arena instead of freeing it
+        EXPECT_EQ(arena.blockCount(), 1u);
+    }
+}
+
+TEST(ASTFactoryTest, ArenaNodeRemoveChild) {
+    Arena arena;
+    auto* root = ASTFactory<int>::createNode(arena, 1);
+    auto* child = ASTFactory<int>::createNode(arena, 2);
+    root->addChild(std::unique_ptr<AbstractTreeNode<int>>(child));
+
+    EXPECT_TRUE(root->removeChild(child));
+    EXPECT_TRUE(root->getChildren().empty());
+
+    SyntaxTree<int> tree(arena);
+    tree.setRoot(root);
+    tree.clear();
+    EXPECT_EQ(tree.getRoot(), nullptr);
+}
+
+TEST(ASTFactoryTest, ArenaTreeRejectsHeapNodes) {
+    Arena arena;
+    auto* root = ASTFactory<int>::createNode(arena, 1);
+    std::unique_ptr<AbstractTreeNode<int>> heap(ASTFactory<int>::createNode(2));
+
+    // clear() would skip the heap node and leak it
+    EXPECT_THROW(root->addChild(std::make_unique<TreeNode<int>>(3)), std::invalid_argument);
+    EXPECT_TRUE(root->getChildren().empty());
+
+    SyntaxTree<int> tree(arena);
+    EXPECT_THROW(tree.setRoot(heap.get()), std::invalid_argument);
+    EXPECT_EQ(tree.getRoot(), nullptr);
+
+    tree.setRoot(root);
+    tree.clear();
+    EXPECT_EQ(tree.getRoot(), nullptr);
+}
+
+TEST(FlatTreeTest, FlattenAndExpandRoundTrip) {
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    buildLoad(*tree, [](const std::string& v) { return ASTFactory<std::string>::createNode(v); });
+    auto* extra = ASTFactory<std::string>::createNode("register");
+    tree->getRoot()->getChildren()[0]->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(extra));
+
+    FlatTree<std::string> flat = flatten(*tree);
+    ASSERT_EQ(flat.size(), 4u);
+    // Pre-order, with equal values interned once
+    EXPECT_EQ(flat.value(0), "load");
+    EXPECT_EQ(flat.value(1), "register");
+    EXPECT_EQ(flat.value(2), "register");
+    EXPECT_EQ(flat.value(3), "immediate");
+    EXPECT_EQ(flat.values().size(), 3u);
+    EXPECT_EQ(flat.valueId(1), flat.valueId(2));
+    EXPECT_EQ(flat.childCount(0), 2u);
+    EXPECT_EQ(flat.firstChild(1), 2u);
+    EXPECT_EQ(flat.nextSibling(1), 3u);
+    EXPECT_EQ(flat.nextSibling(3), FlatTree<std::string>::npos);
+
+    std::unique_ptr<AbstractTree<std::string>> rebuilt(expand(flat));
+    std::ostringstream before, after;
+    tree->traverse(before);
+    rebuilt->traverse(after);
+    EXPECT_EQ(after.str(), before.str());
+
+    tree->clear();
+    rebuilt->clear();
+}
+
+TEST(SyntaxTreeTest, VisitorOrders) {
+    // a(b(d, e), c)
+    SyntaxTree<std::string> tree;
+    auto* a = ASTFactory<std::string>::createNode("a");
+    auto* b = ASTFactory<std::string>::createNode("b");
+    b->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("d")));
+    b->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("e")));
+    a->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(b));
+    a->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("c")));
+    tree.setRoot(a);
+
+    auto collect = [&](TraversalOrder order) {
+        std::string out;
+        tree.visit(order, [&](const AbstractTreeNode<std::string>& node, std::size_t depth) {
+            out += node.getValue() + std::to_string(depth);
+        });
+        return out;
+    };
+    EXPECT_EQ(collect(TraversalOrder::PreOrder), "a0b1d2e2c1");
+    EXPECT_EQ(collect(TraversalOrder::InOrder), "d2b1e2a0c1");
+    EXPECT_EQ(collect(TraversalOrder::PostOrder), "d2e2b1c1a0");
+    EXPECT_EQ(collect(TraversalOrder::LevelOrder), "a0b1c1d2e2");
+
+    // Early exit stops the walk and is reported
+    std::string seen;
+    bool completed = tree.visitPreorder([&](const AbstractTreeNode<std::string>& node, std::size_t) {
+        seen += node.getValue();
+        return node.getValue() != "d";
+    });
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(seen, "abd");
+
+    tree.clear();
+}
+
+TEST(SyntaxTreeTest, DeepTreeWithoutRecursion) {
+    // A chain deep enough to overflow the stack with recursive walks
+    constexpr int depth = 1000000;
+    SyntaxTree<int> tree;
+    auto* root = ASTFactory<int>::createNode(0);
+    AbstractTreeNode<int>* tail = root;
+    for (int i = 1; i < depth; ++i) {
+        auto* next = ASTFactory<int>::createNode(i);
+        tail->addChild(std::unique_ptr<AbstractTreeNode<int>>(next));
+        tail = next;
+    }
+    tree.setRoot(root);
+
+    std::size_t count = 0, maxDepth = 0;
+    EXPECT_TRUE(tree.visitPostorder([&](const AbstractTreeNode<int>&, std::size_t d) {
+        ++count;
+        maxDepth = std::max(maxDepth, d);
+    }));
+    EXPECT_EQ(count, static_cast<std::size_t>(depth));
+    EXPECT_EQ(maxDepth, static_cast<std::size_t>(depth - 1));
+
+    tree.clear();
+    EXPECT_EQ(tree.getRoot(), nullptr);
+}
@@ -0,0 +1,134 @@
+#include "../include/Assembler.hpp"
+#include "../include/BatchAssembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/ThreadPool.hpp"
+#include "TestSpec.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class BatchAssemblerTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        for (const std::string& path : files) {
+            std::remove(path.c_str());
+        }
+    }
+
+    std::string writeFile(const std::string& name, const std::string& text) {
+        std::string path = ::testing::TempDir() + name;
+        std::ofstream(path) << text;
+        files.push_back(path);
+        return path;
+    }
+
+    // What a single-file run produces for the same source
+    static BatchResult singleFile(const std::string& source) {
+        BatchResult result;
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens);
+        Assembler assembler(encoder());
+        testing::internal::CaptureStderr();
+        result.ok = assembler.assemble(lexer);
+        result.diagnostics = testing::internal::GetCapturedStderr();
+        if (result.ok) {
+            assembler.encode(result.words);
+        }
+        return result;
+    }
+
+    static const Encoder& encoder() { return testSpec().encoder; }
+    std::vector<std::string> files;
+};
+
+} // namespace
+
+TEST_F(BatchAssemblerTest, MatchesSingleFileRuns) {
+    std::vector<std::string> sources;
+    std::vector<std::string> inputs;
+    for (int i = 0; i < 64; ++i) {
+        std::string source = "start: addi x1, x0, " + std::to_string(i) + "\n"
+                             "add x2, x1, x1\n"
+                             "bne x1, x0, start\n";
+        if (i % 7 == 3) {
+            source += "beq x1, x2, missing\n";     // Some files fail
+        }
+        sources.push_back(source);
+        inputs.push_back(writeFile("batch" + std::to_string(i) + ".s", source));
+    }
+
+    ThreadPool pool(4);
+    BatchAssembler batch(encoder(), pool);
+    std::vector<BatchResult> results = batch.assemble(inputs);
+    ASSERT_EQ(results.size(), inputs.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        BatchResult expected = singleFile(sources[i]);
+        EXPECT_EQ(results[i].input, inputs[i]);
+        EXPECT_EQ(results[i].ok, expected.ok) << i;
+        EXPECT_EQ(results[i].words, expected.words) << i;
+        EXPECT_EQ(results[i].diagnostics, expected.diagnostics) << i;
+    }
+    EXPECT_FALSE(results[3].ok);
+
+    // Scratch is reused: a second batch gives the same answers
+    std::vector<BatchResult> again = batch.assemble(inputs);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(again[i].words, results[i].words) << i;
+        EXPECT_EQ(again[i].diagnostics, results[i].diagnostics) << i;
+    }
+}
+
+TEST_F(BatchAssemblerTest, MissingFileIsReportedPerFile) {
+    std::vector<std::string> inputs = {
+        writeFile("present.s", "add x1, x2, x3\n"),
+        ::testing::TempDir() + "does-not-exist.s"
+    };
+    ThreadPool pool(2);
+    BatchAssembler batch(encoder(), pool);
+    std::vector<BatchResult> results = batch.assemble(inputs);
+    EXPECT_TRUE(results[0].ok);
+    EXPECT_EQ(results[0].words, std::vector<std::uint32_t>{0x003100B3u});
+    EXPECT_FALSE(results[1].ok);
+    EXPECT_NE(results[1].diagnostics.find("does-not-exist.s"), std::string::npos);
+}
+
+TEST_F(BatchAssemblerTest, SpecCanAddInstructions) {
+    Encoder extended = encoder();
+    std::vector<Token> rrr(3, Token(TokenType::REGISTER));
+    std::vector<BitField> mulx = {{7, "0000001"}, {5, "register3"}, {5, "register2"},
+                                  {3, "000"}, {5, "register1"}, {7, "0110011"}};
+    ASSERT_TRUE(extended.addInstruction("mulx", rrr, mulx));
+    EXPECT_TRUE(encoder().builtinMnemonicsOnly());
+    EXPECT_FALSE(extended.builtinMnemonicsOnly());
+
+    std::vector<std::string> inputs = {writeFile("mulx.s", "mulx x1, x2, x3\nadd x1, x1, x1\n")};
+    ThreadPool pool(1);
+    BatchAssembler batch(extended, pool);
+    std::vector<BatchResult> results = batch.assemble(inputs);
+    EXPECT_TRUE(results[0].ok) << results[0].diagnostics;
+    EXPECT_EQ(results[0].words, (std::vector<std::uint32_t>{0x023100B3u, 0x001080B3u}));
+}
+
+TEST_F(BatchAssemblerTest, ReadsManifest) {
+    std::string manifest = writeFile("manifest.txt",
+                                     "# test programs\n"
+                                     "a.s\n"
+                                     "\n"
+                                     "  sub/b.s  \n"
+                                     "/abs/c.s\n");
+    std::vector<std::string> inputs;
+    ASSERT_TRUE(BatchAssembler::readManifest(manifest, inputs));
+    ASSERT_EQ(inputs.size(), 3u);
+    EXPECT_EQ(inputs[0], ::testing::TempDir() + "a.s");
+    EXPECT_EQ(inputs[1], ::testing::TempDir() + "sub/b.s");
+    EXPECT_EQ(inputs[2], "/abs/c.s");
+
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(BatchAssembler::readManifest(::testing::TempDir() + "no-manifest.txt", inputs));
+    testing::internal::GetCapturedStderr();
+}
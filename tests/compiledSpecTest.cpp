@@ -0,0 +1,120 @@
+#include "../include/CompiledSpec.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const char* kSpec =
+    "load : [register : any] [immediate : any] [punctuation : (] [register : any] [punctuation : )]\n"
+    "[12 : immediate(11:0)] [5 : register2] [3 : 010] [5 : register1] [7 : 0000011]\n"
+    "add : [register : any] [register : any] [register : any]\n"
+    "[7 : 0000000] [5 : register3] [5 : register2] [3 : 000] [5 : register1] [7 : 0110011]\n";
+
+class CompiledSpecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::string base = ::testing::TempDir() + "spec_" + std::to_string(::getpid());
+        specPath = base + ".txt";
+        cachePath = base + ".bin";
+        writeSpec(kSpec);
+        std::remove(cachePath.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(specPath.c_str());
+        std::remove(cachePath.c_str());
+    }
+
+    void writeSpec(const std::string& text) {
+        std::ofstream out(specPath, std::ios::trunc);
+        out << text;
+    }
+
+    std::string specPath;
+    std::string cachePath;
+};
+
+} // namespace
+
+TEST_F(CompiledSpecTest, MatchesRegexReader) {
+    std::unordered_map<std::string, std::vector<Token>> expectedParams, params;
+    std::unordered_map<std::string, std::vector<BitField>> expectedBits, bits;
+    ASSERT_TRUE(parseInstructionFile(specPath, expectedParams, expectedBits));
+
+    CompiledSpec spec(specPath, cachePath);
+    EXPECT_FALSE(spec.loadedFromCache());
+    ASSERT_EQ(spec.size(), 2u);
+    spec.toMaps(params, bits);
+
+    ASSERT_EQ(params.size(), expectedParams.size());
+    for (const auto& [name, tokens] : expectedParams) {
+        ASSERT_EQ(params[name].size(), tokens.size()) << name;
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            EXPECT_EQ(params[name][i], tokens[i]) << name << " token " << i;
+        }
+        ASSERT_EQ(bits[name].size(), expectedBits[name].size()) << name;
+        for (size_t i = 0; i < bits[name].size(); ++i) {
+            EXPECT_EQ(bits[name][i].bitCount, expectedBits[name][i].bitCount);
+            EXPECT_EQ(bits[name][i].field, expectedBits[name][i].field);
+        }
+    }
+
+    size_t load = spec.find("load");
+    ASSERT_NE(load, CompiledSpec::npos);
+    EXPECT_EQ(spec.name(load), "load");
+    EXPECT_EQ(spec.tokens(load)[2].value, '(');
+    EXPECT_EQ(spec.fieldText(spec.fields(load)[0]), "immediate(11:0)");
+    EXPECT_EQ(spec.find("lw"), CompiledSpec::npos);
+}
+
+TEST_F(CompiledSpecTest, ReusesAndInvalidatesCache) {
+    { CompiledSpec spec(specPath, cachePath); EXPECT_FALSE(spec.loadedFromCache()); }
+    { CompiledSpec spec(specPath, cachePath); EXPECT_TRUE(spec.loadedFromCache()); }
+
+    // Editing the spec makes the cache stale
+    writeSpec(std::string(kSpec) + "nop : \n[32 : 00000000000000000000000000010011]\n");
+    {
+        CompiledSpec spec(specPath, cachePath);
+        EXPECT_FALSE(spec.loadedFromCache());
+        EXPECT_NE(spec.find("nop"), CompiledSpec::npos);
+    }
+
+    // A corrupted cache fails its checksum and is rebuilt
+    {
+        std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+    CompiledSpec spec(specPath, cachePath);
+    EXPECT_FALSE(spec.loadedFromCache());
+    EXPECT_EQ(spec.size(), 3u);
+}
+
+TEST_F(CompiledSpecTest, DefaultCacheLivesInCacheDirectory) {
+    std::string cacheHome = ::testing::TempDir() + "xdg_" + std::to_string(::getpid());
+    const char* saved = std::getenv("XDG_CACHE_HOME");
+    std::string savedValue = saved ? saved : "";
+    ::setenv("XDG_CACHE_HOME", cacheHome.c_str(), 1);
+
+    std::string cache = CompiledSpec::defaultCachePath(specPath);
+    EXPECT_EQ(cache.rfind(cacheHome + "/nanoforge/", 0), 0u) << cache;
+    EXPECT_NE(cache, CompiledSpec::defaultCachePath(specPath + ".other"));
+
+    { CompiledSpec spec(specPath); EXPECT_FALSE(spec.loadedFromCache()); }
+    { CompiledSpec spec(specPath); EXPECT_TRUE(spec.loadedFromCache()); }
+    // Nothing is written next to the spec
+    EXPECT_FALSE(std::ifstream(specPath + ".bin").good());
+
+    std::remove(cache.c_str());
+    std::filesystem::remove_all(cacheHome);
+    if (saved) {
+        ::setenv("XDG_CACHE_HOME", savedValue.c_str(), 1);
+    } else {
+        ::unsetenv("XDG_CACHE_HOME");
+    }
+}
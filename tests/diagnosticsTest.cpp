@@ -0,0 +1,42 @@
+#include "../include/Diagnostics.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+TEST(DiagnosticsTest, FormatsArgumentsWhenWritten) {
+    Diagnostics diagnostics;
+    std::string value = "addi";
+    EXPECT_TRUE(diagnostics.report(DiagnosticCode::ArityMismatch, 3, 7, value, 3, std::size_t{2}));
+    // Text args are copied: the caller's string can change afterwards
+    value = "xxxx";
+    EXPECT_TRUE(diagnostics.report(DiagnosticCode::InvalidNode, 0, 0, "bogus"));
+    EXPECT_TRUE(diagnostics.report(DiagnosticCode::EmptyTree, 0, 0));
+
+    ASSERT_EQ(diagnostics.size(), 3u);
+    EXPECT_EQ(diagnostics.entries()[0].line, 3);
+    EXPECT_EQ(diagnostics.format(diagnostics.entries()[0]),
+              "Syntax Error (line 3, column 7): Node 'addi' expects 3 parameters, but has 2.");
+    EXPECT_EQ(diagnostics.format(diagnostics.entries()[1]), "Syntax Error: Invalid node value 'bogus'.");
+
+    std::ostringstream out;
+    diagnostics.write(out);
+    EXPECT_EQ(out.str(),
+              "Syntax Error (line 3, column 7): Node 'addi' expects 3 parameters, but has 2.\n"
+              "Syntax Error: Invalid node value 'bogus'.\n"
+              "Warning! The tree is empty (no root node).\n");
+
+    diagnostics.clear();
+    EXPECT_TRUE(diagnostics.empty());
+    EXPECT_EQ(diagnostics.str(), "");
+}
+
+TEST(DiagnosticsTest, StopsAtTheCap) {
+    Diagnostics diagnostics(2);
+    EXPECT_TRUE(diagnostics.report(DiagnosticCode::InvalidNode, 1, 1, "a"));
+    EXPECT_FALSE(diagnostics.full());
+    EXPECT_FALSE(diagnostics.report(DiagnosticCode::InvalidNode, 2, 1, "b"));
+    EXPECT_TRUE(diagnostics.full());
+    EXPECT_FALSE(diagnostics.report(DiagnosticCode::InvalidNode, 3, 1, "c"));
+    EXPECT_EQ(diagnostics.size(), 2u);
+    EXPECT_NE(diagnostics.str().find("Stopped after 2 errors."), std::string::npos);
+}
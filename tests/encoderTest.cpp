@@ -0,0 +1,151 @@
+#include "ISATables.hpp"
+#include "../include/Encoder.hpp"
+#include "../include/ThreadPool.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto rv32iEncodings = compileEncodings(isa::instructions, isa::fields);
+
+constexpr std::uint32_t encodeOp(isa::Opcode op, std::array<std::int32_t, 5> values) {
+    return encode(rv32iEncodings[static_cast<std::size_t>(op)], values.data());
+}
+
+// Reference words from the RISC-V spec / GNU as
+static_assert(encodeOp(isa::Opcode::ADD, {1, 2, 3}) == 0x003100B3);          // add x1, x2, x3
+static_assert(encodeOp(isa::Opcode::SUB, {5, 6, 7}) == 0x407302B3);          // sub x5, x6, x7
+static_assert(encodeOp(isa::Opcode::ADDI, {1, 0, 5}) == 0x00500093);         // addi x1, x0, 5
+static_assert(encodeOp(isa::Opcode::ADDI, {1, 1, -1}) == 0xFFF08093);        // addi x1, x1, -1
+static_assert(encodeOp(isa::Opcode::SRAI, {1, 2, 3}) == 0x40315093);         // srai x1, x2, 3
+static_assert(encodeOp(isa::Opcode::LW, {1, 4, 0, 2, 0}) == 0x00412083);     // lw x1, 4(x2)
+static_assert(encodeOp(isa::Opcode::SW, {5, 8, 0, 2, 0}) == 0x00512423);     // sw x5, 8(x2)
+static_assert(encodeOp(isa::Opcode::BEQ, {1, 2, 8}) == 0x00208463);          // beq x1, x2, 8
+static_assert(encodeOp(isa::Opcode::BNE, {1, 2, -4}) == 0xFE209EE3);         // bne x1, x2, -4
+static_assert(encodeOp(isa::Opcode::JAL, {1, 2048}) == 0x001000EF);          // jal x1, 2048
+static_assert(encodeOp(isa::Opcode::LUI, {5, 0x12345}) == 0x123452B7);       // lui x5, 0x12345
+
+} // namespace
+
+TEST(EncoderTest, RuntimeSpecMatchesGeneratedTables) {
+    // Rebuild the encodings from BitField lists, the way a parsed spec is used
+    Encoder encoder;
+    for (std::size_t op = 0; op < isa::kInstructionCount; ++op) {
+        std::vector<Token> pattern;
+        for (const isa::OperandPattern& operand : isa::operandsOf(static_cast<isa::Opcode>(op))) {
+            pattern.emplace_back(operand.type, operand.punctuation);
+        }
+        std::vector<BitField> fields;
+        for (const isa::FieldLayout& field : isa::fieldsOf(static_cast<isa::Opcode>(op))) {
+            std::string text;
+            if (field.kind == isa::FieldKind::Register) {
+                int n = 0;
+                for (std::size_t i = 0; i <= field.operand; ++i) {
+                    n += pattern[i].type == TokenType::REGISTER;
+                }
+                text = "register" + std::to_string(n);
+            } else if (field.kind == isa::FieldKind::Immediate) {
+                text = "immediate(" + std::to_string(field.hi) + ":" + std::to_string(field.lo) + ")";
+            } else {
+                for (int b = field.bitCount - 1; b >= 0; --b) {
+                    text += ((field.constant >> b) & 1) ? '1' : '0';
+                }
+            }
+            fields.push_back(BitField{field.bitCount, text});
+        }
+        ASSERT_TRUE(encoder.addInstruction(isa::instructions[op].name, pattern, fields));
+    }
+
+    ASSERT_EQ(encoder.size(), isa::kInstructionCount);
+    std::vector<Token> operands = {
+        Token(TokenType::REGISTER, 0, 2, 1, 7),
+        Token(TokenType::IMMEDIATE, 0, 2, 1, -20),
+        Token(TokenType::PUNCTUATION, 0, 1, 1, '('),
+        Token(TokenType::REGISTER, 0, 2, 1, 9),
+        Token(TokenType::PUNCTUATION, 0, 1, 1, ')'),
+    };
+    std::int32_t values[5] = {7, -20, '(', 9, ')'};
+    for (std::size_t op = 0; op < isa::kInstructionCount; ++op) {
+        std::size_t id = encoder.find(isa::instructions[op].name);
+        ASSERT_NE(id, Encoder::npos);
+        EXPECT_EQ(encoder.encode(id, operands), encode(rv32iEncodings[op], values))
+            << isa::instructions[op].name;
+    }
+}
+
+TEST(EncoderTest, BuiltinMatchesGeneratedTables) {
+    Encoder encoder = Encoder::builtin();
+    ASSERT_EQ(encoder.size(), isa::kInstructionCount);
+
+    std::vector<Token> operands = {
+        Token(TokenType::REGISTER, 0, 2, 1, 7),
+        Token(TokenType::IMMEDIATE, 0, 2, 1, -20),
+        Token(TokenType::PUNCTUATION, 0, 1, 1, '('),
+        Token(TokenType::REGISTER, 0, 2, 1, 9),
+        Token(TokenType::PUNCTUATION, 0, 1, 1, ')'),
+    };
+    std::int32_t values[5] = {7, -20, '(', 9, ')'};
+    for (std::size_t op = 0; op < isa::kInstructionCount; ++op) {
+        EXPECT_EQ(encoder.find(isa::instructions[op].name), op);
+        EXPECT_EQ(encoder.pattern(op).size(), isa::instructions[op].operandCount);
+        EXPECT_EQ(encoder.encode(op, operands), encode(rv32iEncodings[op], values))
+            << isa::instructions[op].name;
+    }
+}
+
+TEST(EncoderTest, RejectsBadLayouts) {
+    Encoder encoder;
+    std::vector<Token> pattern = {Token(TokenType::REGISTER)};
+    std::vector<BitField> tooShort = {{5, "register1"}, {7, "0110011"}};
+    std::vector<BitField> badOperand = {{5, "register2"}, {27, "0"}};
+    EXPECT_FALSE(encoder.addInstruction("short", pattern, tooShort));
+    EXPECT_FALSE(encoder.addInstruction("bad", pattern, badOperand));
+    EXPECT_EQ(encoder.size(), 0u);
+}
+
+TEST(EncoderTest, ImmediateRanges) {
+    const Encoding& addi = rv32iEncodings[static_cast<std::size_t>(isa::Opcode::ADDI)];
+    EXPECT_TRUE(immediateFits(addi, -2048));
+    EXPECT_TRUE(immediateFits(addi, 4095));
+    EXPECT_FALSE(immediateFits(addi, 4096));
+    EXPECT_FALSE(immediateFits(addi, -2049));
+
+    const Encoding& beq = rv32iEncodings[static_cast<std::size_t>(isa::Opcode::BEQ)];
+    EXPECT_TRUE(immediateFits(beq, -4096));
+    EXPECT_FALSE(immediateFits(beq, 3));    // Branch offsets are even
+}
+
+TEST(EncoderTest, EncodeAllMatchesSequential) {
+    Encoder encoder;
+    std::vector<Token> rrr = {Token(TokenType::REGISTER), Token(TokenType::REGISTER), Token(TokenType::REGISTER)};
+    std::vector<BitField> add = {{7, "0000000"}, {5, "register3"}, {5, "register2"},
+                                 {3, "000"}, {5, "register1"}, {7, "0110011"}};
+    std::vector<BitField> sub = {{7, "0100000"}, {5, "register3"}, {5, "register2"},
+                                 {3, "000"}, {5, "register1"}, {7, "0110011"}};
+    ASSERT_TRUE(encoder.addInstruction("add", rrr, add));
+    ASSERT_TRUE(encoder.addInstruction("sub", rrr, sub));
+
+    // Large enough to be split across the pool
+    const std::size_t count = 200000;
+    std::vector<InstructionRecord> program;
+    std::vector<Token> operands;
+    for (std::size_t i = 0; i < count; ++i) {
+        program.push_back({static_cast<std::uint32_t>(i % 2), static_cast<std::uint32_t>(operands.size())});
+        for (int r = 0; r < 3; ++r) {
+            operands.emplace_back(TokenType::REGISTER, 0, 2, 1, static_cast<std::int32_t>((i + r) % 32));
+        }
+    }
+
+    ThreadPool pool(4);
+    std::vector<std::uint32_t> words(count);
+    encoder.encodeAll(program, operands, words, pool);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::span<const Token> ops(operands.data() + program[i].firstOperand, 3);
+        ASSERT_EQ(words[i], encoder.encode(program[i].id, ops)) << i;
+    }
+
+    std::vector<std::uint32_t> wrongSize(count - 1);
+    EXPECT_THROW(encoder.encodeAll(program, operands, wrongSize, pool), std::length_error);
+}
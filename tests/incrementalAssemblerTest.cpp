@@ -0,0 +1,235 @@
+#include "../include/Assembler.hpp"
+#include "../include/IncrementalAssembler.hpp"
+#include "../include/Lexer.hpp"
+#include "TestSpec.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class IncrementalAssemblerTest : public ::testing::Test {
+protected:
+    // Reference result: a from-scratch single-pass build
+    static std::vector<std::uint32_t> fullBuild(std::string_view source) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens);
+        Assembler assembler(encoder());
+        EXPECT_TRUE(assembler.assemble(lexer));
+        std::vector<std::uint32_t> words;
+        assembler.encode(words);
+        return words;
+    }
+
+    static const Encoder& encoder() { return testSpec().encoder; }
+};
+
+const std::string kProgram =
+    "start:\n"
+    "addi x1, x0, 10\n"
+    "loop: addi x1, x1, -1\n"
+    "\n"
+    "bne x1, x0, loop\n"
+    "beq x0, x0, end\n"
+    "add x2, x2, x2\n"
+    "sw x2, 8(x3)\n"
+    "end: jal x0, start\n";
+
+std::string replaceLine(const std::string& source, const std::string& from, const std::string& to) {
+    std::string result = source;
+    result.replace(result.find(from), from.size(), to);
+    return result;
+}
+
+} // namespace
+
+TEST_F(IncrementalAssemblerTest, FirstRunMatchesFullBuild) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+    EXPECT_EQ(incremental.words(), fullBuild(kProgram));
+    EXPECT_EQ(incremental.words()[1], 0xFFF08093u);    // addi x1, x1, -1
+    EXPECT_EQ(incremental.linesRelexed(), 9u);
+}
+
+TEST_F(IncrementalAssemblerTest, EditRelexesOnlyChangedLine) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    std::string edited = replaceLine(kProgram, "add x2, x2, x2", "sub x2, x2, x4");
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.linesRelexed(), 1u);
+    EXPECT_EQ(incremental.wordsEncoded(), 1u);
+    EXPECT_EQ(incremental.words(), fullBuild(edited));
+
+    // Unchanged source: nothing to do
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.linesRelexed(), 0u);
+    EXPECT_EQ(incremental.wordsEncoded(), 0u);
+}
+
+TEST_F(IncrementalAssemblerTest, InsertionReencodesCrossingBranches) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    // One new instruction between 'beq ... end' and 'end': only the beq and
+    // the jal back to start change offset, the bne stays as it was
+    std::string edited = replaceLine(kProgram, "add x2, x2, x2\n", "add x2, x2, x2\nxor x5, x5, x5\n");
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.linesRelexed(), 1u);
+    EXPECT_EQ(incremental.wordsEncoded(), 3u);
+    EXPECT_EQ(incremental.words(), fullBuild(edited));
+
+    // And back again
+    ASSERT_TRUE(incremental.assemble(kProgram));
+    EXPECT_EQ(incremental.words(), fullBuild(kProgram));
+}
+
+TEST_F(IncrementalAssemblerTest, EditNextToUnmovedLabelStaysLocal) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    // The line defines 'loop', but the label keeps its address, so the
+    // references to it elsewhere are not revisited
+    std::string edited = replaceLine(kProgram, "loop: addi x1, x1, -1", "loop: addi x1, x1, -2");
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.linesRelexed(), 1u);
+    EXPECT_EQ(incremental.wordsEncoded(), 1u);
+    EXPECT_EQ(incremental.words(), fullBuild(edited));
+}
+
+TEST_F(IncrementalAssemblerTest, LabelEditsMatchFullBuild) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    // Each step edits the previous one: move, rename, add and drop labels
+    std::vector<std::string> steps;
+    steps.push_back(replaceLine(kProgram, "loop: addi x1, x1, -1\n\n", "addi x1, x1, -1\nloop:\n"));
+    steps.push_back(replaceLine(steps.back(), "end: jal x0, start", "last: jal x0, start"));
+    steps.back() = replaceLine(steps.back(), "beq x0, x0, end", "beq x0, x0, last");
+    steps.push_back(replaceLine(steps.back(), "start:\n", ""));
+    steps.back() = replaceLine(steps.back(), "jal x0, start", "jal x0, loop");
+    steps.push_back("extra: add x0, x0, x0\nbeq x0, x0, extra\n" + steps.back());
+    steps.push_back(steps.back() + "jal x1, extra\nbeq x1, x1, last\n");
+    steps.push_back(kProgram);
+    for (const std::string& step : steps) {
+        ASSERT_TRUE(incremental.assemble(step)) << step;
+        EXPECT_EQ(incremental.words(), fullBuild(step)) << step;
+    }
+}
+
+TEST_F(IncrementalAssemblerTest, DuplicateLabelReportedLikeFullBuild) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    // The new definition comes first, so the existing one is the duplicate
+    std::string broken = replaceLine(kProgram, "add x2, x2, x2", "end: add x2, x2, x2");
+    std::ostringstream errors;
+    incremental.setDiagnostics(errors);
+    EXPECT_FALSE(incremental.assemble(broken));
+    EXPECT_EQ(errors.str(), "Assembly Error (line 9, column 1): Label 'end' is already defined\n");
+}
+
+TEST_F(IncrementalAssemblerTest, ExportsSymbolsLikeFullBuild) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+    std::string edited = replaceLine(kProgram, "add x2, x2, x2\n", "");
+    ASSERT_TRUE(incremental.assemble(edited));
+
+    std::deque<Token> tokens;
+    Lexer lexer(edited, tokens);
+    Assembler assembler(encoder());
+    ASSERT_TRUE(assembler.assemble(lexer));
+    const SymbolTable& expected = assembler.symbols();
+
+    SymbolTable symbols;
+    incremental.exportSymbols(symbols);
+    ASSERT_EQ(symbols.size(), expected.size());
+    for (SymbolTable::SymbolId id = 0; id < symbols.size(); ++id) {
+        EXPECT_EQ(symbols.name(id), expected.name(id));
+        EXPECT_EQ(symbols.address(id), expected.address(id));
+    }
+}
+
+TEST_F(IncrementalAssemblerTest, CacheRoundTrip) {
+    std::string cache = IncrementalAssembler::cachePathFor(::testing::TempDir() + "incremental.bin");
+    {
+        IncrementalAssembler incremental(encoder());
+        EXPECT_FALSE(incremental.save(cache));     // Nothing assembled yet
+        ASSERT_TRUE(incremental.assemble(kProgram));
+        ASSERT_TRUE(incremental.save(cache));
+    }
+
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.load(cache));
+    EXPECT_EQ(incremental.words(), fullBuild(kProgram));
+
+    std::string edited = replaceLine(kProgram, "sw x2, 8(x3)", "sw x2, 12(x3)");
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.linesRelexed(), 1u);
+    EXPECT_EQ(incremental.wordsEncoded(), 1u);
+    EXPECT_EQ(incremental.words(), fullBuild(edited));
+
+    // The label index built on the first run is kept up to date
+    edited = replaceLine(edited, "add x2, x2, x2\n", "");
+    ASSERT_TRUE(incremental.assemble(edited));
+    EXPECT_EQ(incremental.words(), fullBuild(edited));
+
+    // A damaged cache is rejected rather than trusted
+    std::FILE* file = std::fopen(cache.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, -1, SEEK_END);
+    std::fputc(0x5A, file);
+    std::fclose(file);
+    IncrementalAssembler reloaded(encoder());
+    EXPECT_FALSE(reloaded.load(cache));
+    EXPECT_TRUE(reloaded.words().empty());
+    std::remove(cache.c_str());
+}
+
+TEST_F(IncrementalAssemblerTest, RemovedLabelIsReported) {
+    IncrementalAssembler incremental(encoder());
+    ASSERT_TRUE(incremental.assemble(kProgram));
+
+    std::string broken = replaceLine(kProgram, "end: jal", "jal");
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(incremental.assemble(broken));
+    std::string errors = testing::internal::GetCapturedStderr();
+    EXPECT_NE(errors.find("line 6, column 13): Undefined label 'end'"), std::string::npos);
+
+    // The next run recovers with a full build
+    ASSERT_TRUE(incremental.assemble(kProgram));
+    EXPECT_EQ(incremental.linesRelexed(), 9u);
+    EXPECT_EQ(incremental.words(), fullBuild(kProgram));
+}
+
+TEST_F(IncrementalAssemblerTest, ReportsLikeFullBuild) {
+    // One problem per line, each caught by a different check
+    const std::string broken =
+        "addi x1, x0\n"
+        "add x1, x2, 5\n"
+        "addi x1, x0, 4096\n"
+        "bad_label: add x1, x1, x1\n"
+        "beq x1, x0, no_where\n"
+        "jal x0, missing\n"
+        "bne x1, x0, other\n"
+        "jal x0, missing\n";
+
+    std::ostringstream full;
+    {
+        std::deque<Token> tokens;
+        Lexer lexer(broken, tokens);
+        Assembler assembler(encoder());
+        assembler.setDiagnostics(full);
+        EXPECT_FALSE(assembler.assemble(lexer));
+    }
+
+    std::ostringstream incremental;
+    IncrementalAssembler assembler(encoder());
+    assembler.setDiagnostics(incremental);
+    EXPECT_FALSE(assembler.assemble(broken));
+    EXPECT_FALSE(full.str().empty());
+    EXPECT_EQ(incremental.str(), full.str());
+}
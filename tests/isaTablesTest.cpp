@@ -0,0 +1,43 @@
+#include "ISATables.hpp"
+#include "../include/RV32I.hpp"
+#include <gtest/gtest.h>
+
+// The tables are usable in constant expressions
+static_assert(isa::kInstructionCount == rv32i::mnemonics.size());
+static_assert(isa::find("add") == static_cast<std::size_t>(isa::Opcode::ADD));
+static_assert(isa::find("nop") == isa::npos);
+static_assert(isa::fieldsOf(isa::Opcode::LW).back().constant == 0b0000011);
+
+TEST(ISATablesTest, EveryBuiltinMnemonicHasAnOpcode) {
+    for (std::size_t i = 0; i < rv32i::mnemonics.size(); ++i) {
+        ASSERT_NE(isa::fromMnemonic[i], isa::npos) << rv32i::mnemonics[i];
+        EXPECT_EQ(isa::instructions[isa::fromMnemonic[i]].name, rv32i::mnemonics[i]);
+    }
+}
+
+TEST(ISATablesTest, LayoutsCoverThirtyTwoBits) {
+    for (std::size_t op = 0; op < isa::kInstructionCount; ++op) {
+        int bits = 0;
+        for (const isa::FieldLayout& field : isa::fieldsOf(static_cast<isa::Opcode>(op))) {
+            bits += field.bitCount;
+        }
+        EXPECT_EQ(bits, 32) << isa::instructions[op].name;
+    }
+}
+
+TEST(ISATablesTest, StoreFieldsResolveToOperands) {
+    // sw rs2, imm(rs1): operands are register, immediate, '(', register, ')'
+    auto operands = isa::operandsOf(isa::Opcode::SW);
+    ASSERT_EQ(operands.size(), 5u);
+    EXPECT_EQ(operands[2].type, TokenType::PUNCTUATION);
+    EXPECT_EQ(operands[2].punctuation, '(');
+
+    auto fields = isa::fieldsOf(isa::Opcode::SW);
+    ASSERT_EQ(fields.size(), 6u);
+    EXPECT_EQ(fields[0].kind, isa::FieldKind::Immediate);
+    EXPECT_EQ(fields[0].hi, 11);
+    EXPECT_EQ(fields[0].lo, 5);
+    EXPECT_EQ(fields[1].kind, isa::FieldKind::Register);
+    EXPECT_EQ(fields[1].operand, 0);    // rs2
+    EXPECT_EQ(fields[2].operand, 3);    // rs1
+}
@@ -1,52 +1,76 @@
 #include "../include/Lexer.hpp"  // Adjust the path if needed
+#include "../include/CharScan.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/RV32I.hpp"
 #include <gtest/gtest.h>
-#include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <regex>
 #include <string>
+#include <unordered_set>
 
-// Utility function to create a sample input stream
-std::istringstream createInputStream(const std::string& input) {
-    return std::istringstream(input);
+// Utility function to write a sample input file and open it for the Lexer
+std::ifstream createInputStream(const std::string& input) {
+    {
+        std::ofstream out("lexer_test_input.asm", std::ios::binary);
+        out << input;
+    }
+    return std::ifstream("lexer_test_input.asm", std::ios::binary);
 }
 
 // Test Suite for Lexer
 class LexerTest : public ::testing::Test {
 protected:
-    
-    // Common setup can go here if needed
+    void TearDown() override {
+        std::remove("lexer_test_input.asm");
+    }
+
+    std::unordered_set<std::string> instructions = {
+        "lui", "jal", "jalr", "beq", "bne", "blt", "bge", "bltu",
+        "bgeu", "lw", "sw", "addi", "ori", "andi", "add", "sub",
+        "sll", "srl", "sra", "or", "and"
+    };
+    std::unordered_set<std::string> punctuation = { "(", ")", ":" };
+    std::deque<Token> parsedTokens;
 };
 
 // Test case: Basic tokenization
 TEST_F(LexerTest, BasicTokenization) {
     std::string input = "add";
     auto source = createInputStream(input);
-    //std::deque<Token> parsedTokens;
-    Lexer lexer(source);
+    Lexer lexer(source, parsedTokens, instructions, punctuation);
 
-    // Assuming Lexer has a method `nextToken()` to fetch tokens
-    auto token = lexer.nextToken();
+    auto token = lexer.getNextToken();
     EXPECT_EQ(token.type, TokenType::INSTRUCTION);
-    EXPECT_EQ(token.lexeme, "add");
+    EXPECT_EQ(lexer.lexeme(token), "add");
 
     // Additional checks for other tokens
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::EoL);
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::EoF);
+    EXPECT_FALSE(lexer.hasMoreTokens());
 }
 
 TEST_F(LexerTest, RegisterTokenization) {
     for (int i = 0; i<= 50; ++i) {
         std::string input = "x" + std::to_string(i);
-        autosource = createInputStream(input);
-        Lexer lexer(source, parsedTokens, instructions);
+        auto source = createInputStream(input);
+        parsedTokens.clear();
+        Lexer lexer(source, parsedTokens, instructions, punctuation);
 
         auto token = lexer.getNextToken();
 
         if (i <= 31) {
             //Regsiters x0 to x31 should be valid
             EXPECT_EQ(token.type, TokenType::REGISTER);
-            EXPECT_EQ(token.lexeme, "x" + std::tostring(i));
-            
+            EXPECT_EQ(lexer.lexeme(token), "x" + std::to_string(i));
+            EXPECT_EQ(token.value, i);
+
         } else {
-            //Registers x32 to x50 are invalid, and should result in null
-            EXPECT_EQ(token.type, nullptr); // not necessarily nullptr
-            EXPECT_EQ(token.lexeme, "x" + std::tostring(i));
+            //Registers x32 to x50 are invalid
+            EXPECT_EQ(token.type, TokenType::ERROR);
+            EXPECT_EQ(lexer.lexeme(token), "x" + std::to_string(i));
         }
     }
 }
@@ -55,6 +79,7 @@ TEST_F(LexerTest, RegisterTokenization) {
 struct ImmediateTestCase {
     std::string input;
     std::string expectedLexeme;
+    std::int32_t expectedValue;
 };
 
 // Test case: Parameterized test for different types of immediate values (binary, hexadecimal, decimal)
@@ -66,9 +91,15 @@ INSTANTIATE_TEST_SUITE_P(
     ImmediateTokenizationTests,
     ImmediateTokenizationTest,
     ::testing::Values(
-        ImmediateTestCase{"0b101010", "0b101010"},  // Binary immediate
-        ImmediateTestCase{"0x1A3F", "0x1A3F"},    // Hexadecimal immediate
-        ImmediateTestCase{"12345", "12345"}       // Decimal immediate
+        ImmediateTestCase{"0b101010", "0b101010", 42},  // Binary immediate
+        ImmediateTestCase{"0x1A3F", "0x1A3F", 0x1A3F},  // Hexadecimal immediate
+        ImmediateTestCase{"12345", "12345", 12345},     // Decimal immediate
+        ImmediateTestCase{"2147483647", "2147483647", INT32_MAX},
+        ImmediateTestCase{"0xFFFFFFFF", "0xFFFFFFFF", -1},
+        ImmediateTestCase{"0x000000001", "0x000000001", 1},
+        ImmediateTestCase{"0b11111111111111111111111111111111", "0b11111111111111111111111111111111", -1},
+        ImmediateTestCase{"-4", "-4", -4},
+        ImmediateTestCase{"-2147483648", "-2147483648", INT32_MIN}
     )
 );
 
@@ -76,12 +107,268 @@ INSTANTIATE_TEST_SUITE_P(
 TEST_P(ImmediateTokenizationTest, ImmediateTokenization) {
     const ImmediateTestCase& testCase = GetParam();
     auto source = createInputStream(testCase.input);
-    std::deque<Token> parsedTokens;
-    Lexer lexer(source, parsedTokens, instructions);
+    Lexer lexer(source, parsedTokens, instructions, punctuation);
 
     auto token = lexer.getNextToken();
     EXPECT_EQ(token.type, TokenType::IMMEDIATE);
-    EXPECT_EQ(token.lexeme, testCase.expectedLexeme);
+    EXPECT_EQ(lexer.lexeme(token), testCase.expectedLexeme);
+    EXPECT_EQ(token.value, testCase.expectedValue);
+}
+
+// Test case: immediates that do not fit 32 bits are errors, not truncated
+TEST_F(LexerTest, OverflowingImmediatesAreErrors) {
+    for (const char* input : {"2147483648", "4294967297", "99999999999", "0x100000000",
+                              "0x1FFFFFFFF", "0b100000000000000000000000000000000"}) {
+        parsedTokens.clear();
+        Lexer lexer(std::string_view(input), parsedTokens);
+        Token token = lexer.getNextToken();
+        EXPECT_EQ(token.type, TokenType::ERROR) << input;
+        EXPECT_EQ(lexer.lexeme(token), input);
+    }
+}
+
+// Test case: '-' is part of a decimal immediate, never silently dropped
+TEST_F(LexerTest, NegativeImmediates) {
+    std::string input = "addi x1, x2, -4\n"
+                        "addi x1,x2,-0\n"
+                        "-2147483649 - 4 -0x10 -x1 x1-8";
+    Lexer lexer(std::string_view(input), parsedTokens);
+
+    std::vector<std::pair<std::string, TokenType>> expected = {
+        {"addi", TokenType::INSTRUCTION}, {"x1", TokenType::REGISTER},
+        {"x2", TokenType::REGISTER}, {"-4", TokenType::IMMEDIATE}, {"", TokenType::EoL},
+        {"addi", TokenType::INSTRUCTION}, {"x1", TokenType::REGISTER},
+        {"x2", TokenType::REGISTER}, {"-0", TokenType::IMMEDIATE}, {"", TokenType::EoL},
+        {"-2147483649", TokenType::ERROR}, {"-", TokenType::ERROR}, {"4", TokenType::IMMEDIATE},
+        {"-0x10", TokenType::ERROR}, {"-x1", TokenType::ERROR},
+        {"x1", TokenType::REGISTER}, {"-8", TokenType::IMMEDIATE}, {"", TokenType::EoL},
+        {"", TokenType::EoF}
+    };
+    for (const auto& [lexeme, type] : expected) {
+        Token token = lexer.getNextToken();
+        EXPECT_EQ(token.type, type) << lexeme;
+        if (type != TokenType::EoL && type != TokenType::EoF) {
+            EXPECT_EQ(lexer.lexeme(token), lexeme);
+        }
+        if (lexeme == "-4" || lexeme == "-8") {
+            EXPECT_EQ(token.value, -std::stoi(lexeme.substr(1)));
+        }
+    }
+}
+
+// Test case: label definitions follow isLabelName(), the rule the
+// assembler also applies to label references
+TEST_F(LexerTest, LabelNames) {
+    EXPECT_TRUE(isLabelName("loop"));
+    EXPECT_TRUE(isLabelName("L2"));
+    EXPECT_FALSE(isLabelName(""));
+    EXPECT_FALSE(isLabelName("end_label"));
+    EXPECT_FALSE(isLabelName("_start"));
+    EXPECT_FALSE(isLabelName("2L"));
+
+    std::string input = "loop: L2: end_label: _start: 2L:";
+    Lexer lexer(std::string_view(input), parsedTokens);
+    for (TokenType type : {TokenType::LABEL, TokenType::LABEL, TokenType::ERROR,
+                           TokenType::ERROR, TokenType::ERROR}) {
+        Token token = lexer.getNextToken();
+        EXPECT_EQ(token.type, type) << lexer.lexeme(token);
+    }
+}
+
+// Test case: the scanner produces exactly what the old regex-based scanner did
+TEST_F(LexerTest, ScannerMatchesRegexReference) {
+    std::string input =
+        "label:\n"
+        "addi x1, x2, (0b1010)\n"
+        "lw x3, (x4)\n"
+        "jal x5, end_label\n"
+        "(addi x6, x7, 0x1f)\n"
+        "end_label:\n"
+        "\n"
+        "  : ,, a::b  x32)(9:\r\n"
+        "sw x8, (x9)";
+
+    // Reference: the regex the Lexer used before the hand-written scanner
+    std::deque<std::pair<std::string, int>> expected;
+    {
+        std::regex re("([a-zA-Z0-9_]+:|[a-zA-Z0-9_]+|\\(|\\))");
+        std::ifstream ref = createInputStream(input);
+        std::string line;
+        int lineNo = 1;
+        while (std::getline(ref, line)) {
+            for (std::sregex_iterator it(line.begin(), line.end(), re), end; it != end; ++it) {
+                expected.emplace_back(it->str(), static_cast<int>(it->position(0)) + 1);
+            }
+            expected.emplace_back("\n", lineNo++);
+        }
+    }
+
+    auto source = createInputStream(input);
+    Lexer lexer(source, parsedTokens, instructions, punctuation);
+
+    int lineNo = 1;
+    for (const auto& exp : expected) {
+        ASSERT_TRUE(lexer.hasMoreTokens());
+        Token token = lexer.getNextToken();
+        EXPECT_EQ(lexer.lexeme(token), exp.first);
+        if (token.type == TokenType::EoL) {
+            EXPECT_EQ(token.line, exp.second);
+            ++lineNo;
+        } else {
+            EXPECT_EQ(token.line, lineNo);
+            EXPECT_EQ(lexer.column(token), exp.second);
+        }
+    }
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::EoF);
+}
+
+// Test case: ifstream, in-memory buffer and mmap inputs give the same tokens
+TEST_F(LexerTest, BufferAndMappedInputMatchStream) {
+    std::string input = "start:\naddi x1, x2, 0x10\n\nlw x3, (x4)\nbogus_label:";
+
+    auto source = createInputStream(input);
+    Lexer streamLexer(source, parsedTokens, instructions, punctuation);
+    std::deque<Token> fromStream(parsedTokens.begin(), parsedTokens.end());
+
+    std::deque<Token> fromBuffer;
+    Lexer bufferLexer(std::string_view(input), fromBuffer, instructions, punctuation);
+
+    MappedFile mapped("lexer_test_input.asm");
+    std::deque<Token> fromMapped;
+    Lexer mappedLexer(mapped, fromMapped, instructions, punctuation);
+
+    ASSERT_EQ(fromBuffer.size(), fromStream.size());
+    ASSERT_EQ(fromMapped.size(), fromStream.size());
+    for (size_t i = 0; i < fromStream.size(); ++i) {
+        EXPECT_EQ(fromBuffer[i], fromStream[i]);
+        EXPECT_EQ(fromBuffer[i].line, fromStream[i].line);
+        EXPECT_EQ(bufferLexer.column(fromBuffer[i]), streamLexer.column(fromStream[i]));
+        EXPECT_EQ(bufferLexer.lexeme(fromBuffer[i]), streamLexer.lexeme(fromStream[i]));
+        EXPECT_EQ(fromMapped[i], fromStream[i]);
+    }
+}
+
+// Test case: empty inputs produce only EoF
+TEST_F(LexerTest, EmptyBuffer) {
+    Lexer lexer(std::string_view(), parsedTokens, instructions, punctuation);
+    ASSERT_EQ(parsedTokens.size(), 1u);
+    EXPECT_EQ(parsedTokens.front().type, TokenType::EoF);
+    EXPECT_EQ(parsedTokens.front().line, 1);
+}
+
+// Test case: streaming mode yields the eager token stream one line at a time
+TEST_F(LexerTest, StreamingMatchesEager) {
+    std::string input = "start:\naddi x1, x2, 0x10\n\nlw x3, (x4)\njal x5, start";
+
+    Lexer eager(std::string_view(input), parsedTokens, instructions, punctuation);
+    std::deque<Token> expected(parsedTokens.begin(), parsedTokens.end());
+
+    std::deque<Token> window;
+    Lexer streaming(std::string_view(input), window, instructions, punctuation, LexMode::Streaming);
+
+    // Nothing is tokenized until the first token is requested
+    EXPECT_TRUE(window.empty());
+
+    for (const Token& exp : expected) {
+        ASSERT_TRUE(streaming.hasMoreTokens());
+        EXPECT_EQ(streaming.peekNextToken(), exp);
+        EXPECT_EQ(streaming.getNextToken(), exp);
+        // The window never holds more than one line's worth of tokens
+        EXPECT_LE(window.size(), 5u);
+    }
+    EXPECT_FALSE(streaming.hasMoreTokens());
+    EXPECT_THROW(streaming.getNextToken(), std::out_of_range);
+}
+
+// Test case: built-in RV32I tables classify mnemonics and ABI register names
+TEST_F(LexerTest, BuiltinRV32IVocabulary) {
+    std::string input = "auipc sp, 0x10\nsw ra, (fp)\nx07 x32 s11 zero frob";
+    Lexer lexer(std::string_view(input), parsedTokens);
+
+    auto next = [&]() { return lexer.getNextToken(); };
+
+    Token auipc = next();
+    EXPECT_EQ(auipc.type, TokenType::INSTRUCTION);
+    EXPECT_EQ(rv32i::mnemonics[auipc.value], "auipc");
+
+    Token sp = next();
+    EXPECT_EQ(sp.type, TokenType::REGISTER);
+    EXPECT_EQ(sp.value, 2);
+    EXPECT_EQ(next().type, TokenType::IMMEDIATE);
+    EXPECT_EQ(next().type, TokenType::EoL);
+
+    EXPECT_EQ(next().type, TokenType::INSTRUCTION);
+    EXPECT_EQ(next().value, 1);                             // ra
+    EXPECT_EQ(next().type, TokenType::PUNCTUATION);
+    EXPECT_EQ(next().value, 8);                             // fp == s0 == x8
+    EXPECT_EQ(next().value, ')');
+    EXPECT_EQ(next().type, TokenType::EoL);
+
+    EXPECT_EQ(next().value, 7);                             // x07
+    EXPECT_EQ(next().type, TokenType::ERROR);               // x32
+    EXPECT_EQ(next().value, 27);                            // s11
+    EXPECT_EQ(next().value, 0);                             // zero
+    EXPECT_EQ(next().type, TokenType::ERROR);               // frob
+}
+
+// Test case: custom instruction sets still drive classification, and keep
+// the original register rule: x0..x31 only, ABI names are not registers
+TEST_F(LexerTest, CustomInstructionSet) {
+    std::unordered_set<std::string> custom = { "frob" };
+    std::string input = "frob add a0 x5 x07 sp";
+    Lexer lexer(std::string_view(input), parsedTokens, custom, punctuation);
+
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::INSTRUCTION);
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::ERROR);     // add: not in the set
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::ERROR);     // a0
+    Token x5 = lexer.getNextToken();
+    EXPECT_EQ(x5.type, TokenType::REGISTER);
+    EXPECT_EQ(x5.value, 5);
+    EXPECT_EQ(lexer.getNextToken().value, 7);                   // x07
+    EXPECT_EQ(lexer.getNextToken().type, TokenType::ERROR);     // sp
+}
+
+// Test case: parallel chunked lexing reproduces the sequential token stream
+TEST_F(LexerTest, ParallelMatchesEager) {
+    std::string input;
+    for (int i = 0; i < 60000; ++i) {
+        input += "loop:\n  addi x1, x2, 0x" + std::to_string(i % 97) + "\n";
+        input += (i % 7 == 0) ? "\n" : "lw a0, (sp)\n";
+    }
+    input += "sw x8, (x9)";     // No trailing newline
+
+    Lexer eager(std::string_view(input), parsedTokens);
+    std::deque<Token> parallelTokens;
+    Lexer parallel(std::string_view(input), parallelTokens, LexMode::Parallel);
+
+    ASSERT_EQ(parallelTokens.size(), parsedTokens.size());
+    for (size_t i = 0; i < parsedTokens.size(); ++i) {
+        ASSERT_EQ(parallelTokens[i], parsedTokens[i]) << "token " << i;
+    }
+}
+
+// Test case: the vectorized run finders agree with the byte-class table
+TEST(CharScanTest, RunFindersMatchClassTable) {
+    std::string bytes;
+    unsigned seed = 12345;
+    const std::string alphabet = "abcXYZ019_() ,:\t\n\r\x80\xff@[`{";
+    for (int i = 0; i < 4096; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        // Long word runs as well as noise, to cover whole-vector steps
+        bytes += (i / 64) % 3 == 0 ? 'w' : alphabet[(seed >> 16) % alphabet.size()];
+    }
+
+    const char* begin = bytes.data();
+    const char* end = begin + bytes.size();
+    for (const char* p = begin; p < end; ++p) {
+        const char* wordEnd = p;
+        while (wordEnd < end && charClassOf(*wordEnd) == CC_WORD) ++wordEnd;
+        const char* tokenStart = p;
+        while (tokenStart < end && charClassOf(*tokenStart) == CC_SEPARATOR) ++tokenStart;
+
+        ASSERT_EQ(findWordEnd(p, end), wordEnd) << "offset " << (p - begin);
+        ASSERT_EQ(findTokenStart(p, end), tokenStart) << "offset " << (p - begin);
+    }
 }
 
 int main(int argc, char **argv) {
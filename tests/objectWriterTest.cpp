@@ -0,0 +1,118 @@
+#include "../include/Assembler.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/ObjectWriter.hpp"
+#include "../include/Reader.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::uint32_t get16(const std::vector<char>& bytes, std::size_t at) {
+    return static_cast<unsigned char>(bytes[at]) | (static_cast<unsigned char>(bytes[at + 1]) << 8);
+}
+
+std::uint32_t get32(const std::vector<char>& bytes, std::size_t at) {
+    return get16(bytes, at) | (get16(bytes, at + 2) << 16);
+}
+
+std::vector<char> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Section header field of section 's'
+std::uint32_t section(const std::vector<char>& elf, std::size_t s, std::size_t field) {
+    return get32(elf, get32(elf, 32) + s * 40 + field);
+}
+
+std::string sectionName(const std::vector<char>& elf, std::size_t s) {
+    std::size_t names = section(elf, get16(elf, 50), 16);
+    return std::string(elf.data() + names + section(elf, s, 0));
+}
+
+} // namespace
+
+TEST(ObjectWriterTest, FlatBinaryIsTheWordsLittleEndian) {
+    std::vector<std::uint32_t> words = {0x00500093, 0xDEADBEEF};
+    ObjectWriter writer;
+    writer.build(words);
+    EXPECT_EQ(writer.size(), 8u);
+    std::vector<char> expected = {'\x93', '\x00', '\x50', '\x00', '\xEF', '\xBE', '\xAD', '\xDE'};
+    EXPECT_EQ(writer.bytes(), expected);
+    EXPECT_STREQ(writer.extension(), ".bin");
+
+    std::string path = ::testing::TempDir() + "object_writer_flat.bin";
+    ASSERT_TRUE(writer.write(path));
+    EXPECT_EQ(readFile(path), expected);
+
+    // Rebuilding truncates the file to the new contents
+    words.pop_back();
+    writer.build(words);
+    ASSERT_TRUE(writer.write(path));
+    EXPECT_EQ(readFile(path).size(), 4u);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(writer.write(::testing::TempDir() + "missing_dir/out.bin"));
+}
+
+TEST(ObjectWriterTest, ElfObjectHasTextAndLabels) {
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+    ASSERT_TRUE(parseInstructionFile(NANOFORGE_SPEC_PATH, paramMap, binaryMap));
+    Encoder encoder(paramMap, binaryMap);
+    Assembler assembler(encoder);
+    std::deque<Token> tokens;
+    Lexer lexer("start: addi x1, x0, 5\nloop: addi x1, x1, 0xFFF\nbne x1, x0, loop\n", tokens);
+    ASSERT_TRUE(assembler.assemble(lexer));
+    std::vector<std::uint32_t> words;
+    assembler.encode(words);
+
+    ObjectWriter writer(ObjectWriter::Format::Elf);
+    writer.build(words, &assembler.symbols());
+    std::string path = ::testing::TempDir() + "object_writer.o";
+    ASSERT_TRUE(writer.write(path));
+    std::vector<char> elf = readFile(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(elf, writer.bytes());
+    ASSERT_EQ(elf.size(), writer.size());
+
+    // Header: ELF32, little-endian, relocatable, RISC-V
+    EXPECT_EQ(std::string(elf.data(), 4), "\x7f" "ELF");
+    EXPECT_EQ(elf[4], 1);
+    EXPECT_EQ(elf[5], 1);
+    EXPECT_EQ(get16(elf, 16), 1u);
+    EXPECT_EQ(get16(elf, 18), 243u);
+    ASSERT_EQ(get16(elf, 48), 6u);
+
+    EXPECT_EQ(sectionName(elf, 1), ".text");
+    EXPECT_EQ(sectionName(elf, 2), ".data");
+    EXPECT_EQ(sectionName(elf, 3), ".symtab");
+    EXPECT_EQ(sectionName(elf, 4), ".strtab");
+    EXPECT_EQ(sectionName(elf, 5), ".shstrtab");
+
+    // .text holds the encoded words
+    std::size_t text = section(elf, 1, 16);
+    ASSERT_EQ(section(elf, 1, 20), words.size() * 4);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        EXPECT_EQ(get32(elf, text + i * 4), words[i]);
+    }
+
+    // Null symbol, .text section symbol, then the labels at their offsets
+    std::size_t symtab = section(elf, 3, 16);
+    std::size_t strtab = section(elf, 4, 16);
+    ASSERT_EQ(section(elf, 3, 20), 4u * 16);
+    EXPECT_EQ(section(elf, 3, 24), 4u);     // sh_link: .strtab
+    auto symbolName = [&](std::size_t k) {
+        return std::string(elf.data() + strtab + get32(elf, symtab + k * 16));
+    };
+    EXPECT_EQ(symbolName(2), "start");
+    EXPECT_EQ(get32(elf, symtab + 2 * 16 + 4), 0u);
+    EXPECT_EQ(symbolName(3), "loop");
+    EXPECT_EQ(get32(elf, symtab + 3 * 16 + 4), 4u);
+    EXPECT_EQ(get16(elf, symtab + 3 * 16 + 14), 1u);
+}
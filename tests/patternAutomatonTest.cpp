@@ -0,0 +1,104 @@
+#include "../include/Encoder.hpp"
+#include "../include/PatternAutomaton.hpp"
+#include "../include/Reader.hpp"
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const Token reg(TokenType::REGISTER, 1);
+const Token imm(TokenType::IMMEDIATE, 4);
+const Token word(TokenType::ERROR);
+const Token lparen(TokenType::PUNCTUATION, '(');
+const Token rparen(TokenType::PUNCTUATION, ')');
+
+PatternAutomaton::Match matchLine(const PatternAutomaton& automaton, std::size_t id,
+                                  std::initializer_list<Token> operands) {
+    return automaton.match(id, std::vector<Token>(operands));
+}
+
+} // namespace
+
+TEST(PatternAutomatonTest, MatchesEachInstructionAgainstItsOwnPattern) {
+    PatternAutomaton automaton;
+    std::vector<Token> rrr = {Token(TokenType::REGISTER), Token(TokenType::REGISTER), Token(TokenType::REGISTER)};
+    std::vector<Token> rri = {Token(TokenType::REGISTER), Token(TokenType::REGISTER), Token(TokenType::IMMEDIATE)};
+    std::vector<Token> load = {Token(TokenType::REGISTER), Token(TokenType::IMMEDIATE),
+                               Token(TokenType::PUNCTUATION, '('), Token(TokenType::REGISTER),
+                               Token(TokenType::PUNCTUATION, ')')};
+    std::vector<Token> ri = {Token(TokenType::REGISTER), Token(TokenType::IMMEDIATE)};
+    ASSERT_TRUE(automaton.add(0, rrr));
+    ASSERT_TRUE(automaton.add(1, rri, true));
+    ASSERT_TRUE(automaton.add(2, load));
+    ASSERT_TRUE(automaton.add(3, ri));
+    // Shared prefixes share states: root, r, rr, rrr, rri, ri, ri(, ri(r, ri(r)
+    EXPECT_EQ(automaton.stateCount(), 9u);
+
+    EXPECT_TRUE(matchLine(automaton, 0, {reg, reg, reg}).ok);
+    EXPECT_FALSE(matchLine(automaton, 0, {reg, reg, imm}).ok);
+    EXPECT_TRUE(matchLine(automaton, 1, {reg, reg, imm}).ok);
+    EXPECT_FALSE(matchLine(automaton, 1, {reg, reg}).ok);
+    EXPECT_TRUE(matchLine(automaton, 2, {reg, imm, lparen, reg, rparen}).ok);
+    EXPECT_FALSE(matchLine(automaton, 2, {reg, imm, rparen, reg, lparen}).ok);
+    // A prefix of a longer pattern only matches the instruction it belongs to
+    EXPECT_FALSE(matchLine(automaton, 2, {reg, imm}).ok);
+    EXPECT_TRUE(matchLine(automaton, 3, {reg, imm}).ok);
+    EXPECT_FALSE(matchLine(automaton, 3, {reg, imm, lparen}).ok);
+
+    // Words stand in for immediates and are reported as label candidates
+    PatternAutomaton::Match match = matchLine(automaton, 1, {reg, reg, word});
+    EXPECT_TRUE(match.ok);
+    EXPECT_EQ(match.labelMask, 0b100u);
+    EXPECT_FALSE(matchLine(automaton, 0, {reg, reg, word}).ok);
+    // ...but only for instructions that take labels
+    EXPECT_FALSE(matchLine(automaton, 3, {reg, word}).ok);
+
+    // Unknown ids and unknown punctuation never match
+    EXPECT_FALSE(matchLine(automaton, 7, {reg}).ok);
+    const Token bracket(TokenType::PUNCTUATION, '[');
+    EXPECT_FALSE(matchLine(automaton, 2, {reg, imm, bracket, reg, rparen}).ok);
+
+    // Redefinition replaces the accept state
+    ASSERT_TRUE(automaton.add(0, ri));
+    EXPECT_TRUE(matchLine(automaton, 0, {reg, imm}).ok);
+    EXPECT_FALSE(matchLine(automaton, 0, {reg, reg, reg}).ok);
+}
+
+TEST(PatternAutomatonTest, RejectsUnrepresentablePatterns) {
+    PatternAutomaton automaton;
+    EXPECT_FALSE(automaton.add(0, std::vector<Token>(33, Token(TokenType::REGISTER))));
+    EXPECT_FALSE(automaton.add(0, std::vector<Token>{Token(TokenType::ERROR)}));
+
+    // At most 12 distinct punctuation characters
+    for (char c = 'a'; c < 'a' + 12; ++c) {
+        EXPECT_TRUE(automaton.add(0, std::vector<Token>{Token(TokenType::PUNCTUATION, c)}));
+    }
+    EXPECT_FALSE(automaton.add(0, std::vector<Token>{Token(TokenType::PUNCTUATION, 'z')}));
+}
+
+TEST(PatternAutomatonTest, SpecPatternsCompileCompactly) {
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    std::unordered_map<std::string, std::vector<BitField>> binaryMap;
+    ASSERT_TRUE(parseInstructionFile(NANOFORGE_SPEC_PATH, paramMap, binaryMap));
+    Encoder encoder(paramMap, binaryMap);
+    ASSERT_EQ(encoder.size(), 37u);
+
+    // RV32I has a handful of operand shapes; 37 instructions share them
+    EXPECT_LE(encoder.automaton().stateCount(), 12u);
+    std::size_t takeLabels = 0;
+    for (const auto& [name, pattern] : paramMap) {
+        std::vector<Token> line;
+        for (const Token& param : pattern) {
+            line.push_back(param.type == TokenType::IMMEDIATE ? word : param);
+        }
+        // Labels go only where the offset is PC-relative: branches and jal
+        bool pcRelative = isPcRelative(encoder.encoding(encoder.find(name)));
+        bool hasImmediate = line != pattern;
+        EXPECT_EQ(encoder.automaton().match(encoder.find(name), line).ok, pcRelative || !hasImmediate) << name;
+        takeLabels += pcRelative ? 1 : 0;
+    }
+    EXPECT_EQ(takeLabels, 7u);      // beq bne blt bge bltu bgeu jal
+}
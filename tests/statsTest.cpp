@@ -0,0 +1,77 @@
+#include "../include/Lexer.hpp"
+#include "../include/Stats.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if NANOFORGE_STATS
+
+TEST(StatsTest, LexerCountsTokensAndBytes) {
+    stats::reset();
+    const std::string source = "loop: addi x1, x1, 1\nbne x1, x0, loop\n";
+    std::deque<Token> tokens;
+    Lexer lexer(source, tokens);
+
+    EXPECT_EQ(stats::value(stats::Counter::Tokens), tokens.size());
+    EXPECT_EQ(stats::value(stats::Counter::BytesRead), source.size());
+    EXPECT_EQ(stats::registry.phases[static_cast<std::size_t>(stats::Phase::Lex)].calls.load(), 1u);
+
+    // Streaming mode counts as the tokens are produced
+    stats::reset();
+    std::deque<Token> window;
+    Lexer streaming(source, window, LexMode::Streaming);
+    std::size_t consumed = 0;
+    while (streaming.hasMoreTokens()) {
+        streaming.getNextToken();
+        ++consumed;
+    }
+    EXPECT_EQ(stats::value(stats::Counter::Tokens), consumed);
+}
+
+TEST(StatsTest, NestedPhasesAreExclusive) {
+    stats::reset();
+    {
+        NF_STATS_PHASE(Assemble);
+        EXPECT_EQ(stats::ScopedPhase::current()->phase(), stats::Phase::Assemble);
+        {
+            NF_STATS_PHASE(Encode);
+            EXPECT_EQ(stats::ScopedPhase::current()->phase(), stats::Phase::Encode);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        EXPECT_EQ(stats::ScopedPhase::current()->phase(), stats::Phase::Assemble);
+    }
+    EXPECT_EQ(stats::ScopedPhase::current(), nullptr);
+
+    auto ns = [](stats::Phase phase) {
+        return stats::registry.phases[static_cast<std::size_t>(phase)].ns.load();
+    };
+    EXPECT_GE(ns(stats::Phase::Encode), 20'000'000u);
+    EXPECT_LT(ns(stats::Phase::Assemble), 20'000'000u);
+}
+
+TEST(StatsTest, JsonReport) {
+    stats::reset();
+    NF_STATS_ADD(Files, 3);
+    std::ostringstream out;
+    stats::writeJson(out, 1234);
+    std::string json = out.str();
+    EXPECT_NE(json.find("\"enabled\": true"), std::string::npos);
+    EXPECT_NE(json.find("\"wall_ns\": 1234"), std::string::npos);
+    EXPECT_NE(json.find("\"lex\": {\"ns\": 0, \"calls\": 0}"), std::string::npos);
+    EXPECT_NE(json.find("\"files\": 3"), std::string::npos);
+    // This binary does not link the allocation hook
+    EXPECT_EQ(json.find("allocations"), std::string::npos);
+}
+
+#else
+
+TEST(StatsTest, CompiledOut) {
+    std::ostringstream out;
+    stats::writeJson(out, 1);
+    EXPECT_NE(out.str().find("\"enabled\": false"), std::string::npos);
+}
+
+#endif
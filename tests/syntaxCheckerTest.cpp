@@ -0,0 +1,203 @@
+#include "../include/ASTFactory.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/SyntaxChecker.hpp"
+#include "../include/ThreadPool.hpp"
+#include "TestSpec.hpp"
+#include <gtest/gtest.h>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+class SyntaxCheckerTest : public ::testing::Test {
+protected:
+    // Check 'source' as a token stream; the diagnostics end up in 'errors'
+    bool check(std::string_view source, LexMode mode = LexMode::Eager) {
+        std::deque<Token> tokens;
+        Lexer lexer(source, tokens, mode);
+        SyntaxChecker checker(paramMap());
+        std::ostringstream captured;
+        std::streambuf* old = std::cerr.rdbuf(captured.rdbuf());
+        bool ok = checker.checkSyntax(lexer);
+        std::cerr.rdbuf(old);
+        errors = captured.str();
+        return ok;
+    }
+
+    static const std::unordered_map<std::string, std::vector<Token>>& paramMap() {
+        return testSpec().paramMap;
+    }
+    std::string errors;
+};
+
+} // namespace
+
+TEST_F(SyntaxCheckerTest, AcceptsWellFormedLines) {
+    const std::string source =
+        "start:\n"
+        "addi x1, x0, 5\n"
+        "loop: add x2, x2, x1\n"
+        "lw x3, 8(x2)\n"
+        "\n"
+        "beq x1, x2, loop\n"
+        "jal x1, done\n"
+        "done:\n";
+    EXPECT_TRUE(check(source)) << errors;
+    EXPECT_TRUE(check(source, LexMode::Streaming)) << errors;
+    EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(SyntaxCheckerTest, ReportsWrongOperandCount) {
+    EXPECT_FALSE(check("addi x1, x0, 5\nadd x1, x2\n"));
+    EXPECT_NE(errors.find("line 2, column 1"), std::string::npos) << errors;
+    EXPECT_NE(errors.find("'add' expects 3 parameters, but has 2"), std::string::npos) << errors;
+
+    EXPECT_FALSE(check("add x1, x2, x3, x4\n"));
+    EXPECT_NE(errors.find("but has 4"), std::string::npos) << errors;
+}
+
+TEST_F(SyntaxCheckerTest, ReportsWrongOperandKind) {
+    EXPECT_FALSE(check("add x1, x2, 0x5\n"));
+    EXPECT_NE(errors.find("Parameter 3 of 'add'"), std::string::npos) << errors;
+    EXPECT_NE(errors.find("column 13"), std::string::npos) << errors;
+
+    // The memory operand's punctuation is part of the pattern
+    EXPECT_FALSE(check("lw x3, 8 x2\n"));
+    EXPECT_NE(errors.find("'lw' expects 5 parameters"), std::string::npos) << errors;
+    EXPECT_FALSE(check("lw x3, x2(8)\n"));
+    EXPECT_NE(errors.find("Parameter 2 of 'lw'"), std::string::npos) << errors;
+}
+
+TEST_F(SyntaxCheckerTest, RejectsLinesThatDoNotStartWithAnInstruction) {
+    EXPECT_FALSE(check("x1, x2\n"));
+    EXPECT_NE(errors.find("Expected an instruction or label, found 'x1'"), std::string::npos) << errors;
+}
+
+TEST_F(SyntaxCheckerTest, ReportsEveryErrorInOnePass) {
+    const std::string source =
+        "add x1, x2\n"
+        "addi x1, x0, 1\n"
+        "x3, x4\n"
+        "add x1, x2, 0x5\n"
+        "sub x1, x2, x3, x4\n";
+    std::deque<Token> tokens;
+    Lexer lexer(source, tokens);
+    SyntaxChecker checker(paramMap());
+    Diagnostics diagnostics;
+    EXPECT_FALSE(checker.checkSyntax(lexer, diagnostics));
+
+    ASSERT_EQ(diagnostics.size(), 4u);
+    const auto& entries = diagnostics.entries();
+    EXPECT_EQ(entries[0].code, DiagnosticCode::ArityMismatch);
+    EXPECT_EQ(entries[0].line, 1);
+    EXPECT_EQ(entries[1].code, DiagnosticCode::ExpectedInstruction);
+    EXPECT_EQ(entries[1].line, 3);
+    EXPECT_EQ(entries[2].code, DiagnosticCode::OperandKind);
+    EXPECT_EQ(entries[2].line, 4);
+    EXPECT_EQ(entries[3].code, DiagnosticCode::ArityMismatch);
+    EXPECT_EQ(entries[3].line, 5);
+}
+
+TEST_F(SyntaxCheckerTest, StopsAtTheErrorCap) {
+    std::string source;
+    for (int i = 0; i < 100; ++i) {
+        source += "add x1, x2\n";
+    }
+    std::deque<Token> tokens;
+    Lexer lexer(source, tokens, LexMode::Streaming);
+    SyntaxChecker checker(paramMap());
+    Diagnostics diagnostics(10);
+    EXPECT_FALSE(checker.checkSyntax(lexer, diagnostics));
+    EXPECT_EQ(diagnostics.size(), 10u);
+    EXPECT_TRUE(diagnostics.full());
+    EXPECT_EQ(diagnostics.entries().back().line, 10);
+}
+
+namespace {
+
+// 'program' over 'count' instruction nodes; every 1000th one is broken
+std::unique_ptr<AbstractTree<std::string>> programTree(std::size_t count) {
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    auto* root = ASTFactory<std::string>::createNode("program");
+    for (std::size_t i = 0; i < count; ++i) {
+        auto* node = ASTFactory<std::string>::createNode(i % 1000 == 999 ? "bogus" : "pair");
+        std::size_t leaves = i % 1000 == 500 ? 1 : 2;
+        for (std::size_t k = 0; k < leaves; ++k) {
+            node->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("leaf")));
+        }
+        root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(node));
+    }
+    tree->setRoot(root);
+    return tree;
+}
+
+} // namespace
+
+TEST(SyntaxCheckerParallelTest, MatchesTheSequentialCheck) {
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    paramMap["program"] = std::vector<Token>(3, Token(TokenType::INSTRUCTION));
+    paramMap["pair"] = {Token(TokenType::REGISTER), Token(TokenType::REGISTER)};
+    paramMap["leaf"];
+    SyntaxChecker checker(paramMap);
+    ThreadPool pool(4);
+
+    auto tree = programTree(100000);
+    Diagnostics sequential;
+    EXPECT_FALSE(checker.checkSyntax(*tree, sequential));
+    Diagnostics parallel;
+    EXPECT_FALSE(checker.checkSyntax(*tree, parallel, pool));
+    // Root arity, then one arity and one invalid node per 1000 children
+    EXPECT_EQ(sequential.size(), 201u);
+    EXPECT_EQ(parallel.str(), sequential.str());
+
+    // The cap cuts both at the same place
+    Diagnostics cappedSequential(50);
+    Diagnostics cappedParallel(50);
+    checker.checkSyntax(*tree, cappedSequential);
+    checker.checkSyntax(*tree, cappedParallel, pool);
+    EXPECT_EQ(cappedParallel.size(), 50u);
+    EXPECT_EQ(cappedParallel.str(), cappedSequential.str());
+}
+
+TEST(SyntaxCheckerParallelTest, ChecksDeepTreesWithoutRecursion) {
+    // A chain deep enough to overflow the stack with a recursive check,
+    // under a root wide enough for the pool to split into tasks
+    constexpr std::size_t depth = 1000000;
+    constexpr std::size_t width = 8 * 1024;
+    std::unordered_map<std::string, std::vector<Token>> paramMap;
+    paramMap["fan"] = std::vector<Token>(width, Token(TokenType::INSTRUCTION));
+    paramMap["wrap"] = {Token(TokenType::INSTRUCTION)};
+    paramMap["leaf"];
+    SyntaxChecker checker(paramMap);
+    ThreadPool pool(4);
+
+    std::unique_ptr<AbstractTree<std::string>> tree(ASTFactory<std::string>::createTree());
+    auto* root = ASTFactory<std::string>::createNode("fan");
+    AbstractTreeNode<std::string>* tail = root;
+    for (std::size_t i = 0; i < depth; ++i) {
+        // One broken node half way down
+        auto* next = ASTFactory<std::string>::createNode(i == depth / 2 ? "bogus" : "wrap");
+        tail->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(next));
+        tail = next;
+    }
+    tail->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("leaf")));
+    for (std::size_t i = 1; i < width; ++i) {
+        root->addChild(std::unique_ptr<AbstractTreeNode<std::string>>(ASTFactory<std::string>::createNode("leaf")));
+    }
+    tree->setRoot(root);
+
+    Diagnostics sequential;
+    EXPECT_FALSE(checker.checkSyntax(*tree, sequential));
+    ASSERT_EQ(sequential.size(), 1u);
+    EXPECT_EQ(sequential.entries().front().code, DiagnosticCode::InvalidNode);
+    Diagnostics parallel;
+    EXPECT_FALSE(checker.checkSyntax(*tree, parallel, pool));
+    EXPECT_EQ(parallel.str(), sequential.str());
+
+    tree->clear();
+}
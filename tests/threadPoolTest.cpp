@@ -0,0 +1,51 @@
+#include "../include/ThreadPool.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+TEST(ThreadPoolTest, RangesCoverEveryIndexOnce) {
+    ThreadPool pool(3);
+    const std::size_t count = 100003;
+    std::vector<std::atomic<int>> hits(count);
+    std::mutex mutex;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+
+    pool.parallelForRanges(count, 1000, [&](std::size_t begin, std::size_t end) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ranges.emplace_back(begin, end);
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(hits[i].load(), 1) << i;
+    }
+    EXPECT_GT(ranges.size(), 1u);
+}
+
+TEST(ThreadPoolTest, NestedWorkIsStolen) {
+    // Every outer iteration fans out again from inside a worker; idle
+    // workers must pick those tasks up (or the caller runs them) without
+    // deadlocking
+    ThreadPool pool(4);
+    std::atomic<int> total{0};
+    pool.parallelFor(16, [&](std::size_t) {
+        pool.parallelFor(64, [&](std::size_t) { total.fetch_add(1); });
+    });
+    EXPECT_EQ(total.load(), 16 * 64);
+
+    std::atomic<int> submitted{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&] { submitted.fetch_add(1); });
+    }
+    // Fire-and-forget tasks drain without help from the caller
+    while (submitted.load() != 100) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(submitted.load(), 100);
+}